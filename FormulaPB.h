@@ -36,7 +36,9 @@
 
 #include "MaxTypes.h"
 
+#include <gmpxx.h>
 #include <map>
+#include <vector>
 
 using NSPACE::Lit;
 using NSPACE::vec;
@@ -45,10 +47,50 @@ namespace openwbo {
 
 typedef std::map<int, int> varMap;
 
+// Read-only view of the terms of a Card or PB constraint, which is what the
+// encodings get instead of a copy. The literals and coefficients stay in the
+// contiguous arrays of the constraint, and the sum, maximum and GCD of the
+// coefficients come from the constraint, which keeps them up to date; the
+// coefficients of a Card are all 1. The encodings flip a constraint to the
+// side with the smaller rhs by negating all of its literals, which the view
+// does on access instead of on a copy.
+class TermView {
+public:
+  TermView(vec<Lit> &lits, const int64_t *coeffs, int64_t sum, int64_t max,
+           int64_t gcd, bool negated = false)
+      : _lits(lits), _coeffs(coeffs), _size(lits.size()), _sum(sum),
+        _max(max), _gcd(gcd), _negated(negated) {}
+
+  int size() const { return _size; }
+  Lit operator[](int i) const { return _lits[i] ^ _negated; }
+  int64_t coeff(int i) const { return _coeffs == NULL ? 1 : _coeffs[i]; }
+
+  int64_t sum() const { return _sum; }
+  int64_t max() const { return _max; }
+  int64_t gcd() const { return _gcd; }
+
+private:
+  const Lit *_lits;
+  const int64_t *_coeffs; // NULL if all coefficients are 1
+  int _size;
+  int64_t _sum, _max, _gcd;
+  bool _negated;
+};
+
 class Constraint {
 public:
-  vec<int> clause_ids;
-  vec<int> proof_expr_id;
+  Constraint()
+      : clause_begin(0), clause_end(0), proof_begin(0), proof_end(0),
+        divisor(1) {}
+
+  int64_t nClauses() const { return clause_end - clause_begin; }
+
+  // The output of an encoder for one constraint is contiguous: the hard
+  // clauses [clause_begin, clause_end) and the proof records at the positions
+  // [proof_begin, proof_end) of the proof buffer.
+  int64_t clause_begin, clause_end;
+  int64_t proof_begin, proof_end;
+  int64_t divisor; // the input constraint was divided by this when parsed
 };
 
 // Cardinality constraint of the form atMostK
@@ -56,7 +98,7 @@ class Card : public Constraint {
 
 public:
   Card(vec<Lit> &lits, int64_t rhs, pb_Sign sign = _PB_LESS_OR_EQUAL_,
-       uint id = 0) {
+       int64_t id = 0) {
     lits.copyTo(_lits);
     _rhs = rhs;
     _sign = sign;
@@ -74,8 +116,31 @@ public:
   Card() { _rhs = 0; }
   ~Card() {}
 
+  // Constraints are handed over, never copied: a moved-from constraint has
+  // no terms.
+  Card(const Card &) = delete;
+  Card &operator=(const Card &) = delete;
+  Card(Card &&other) : Constraint(other) { moveFrom(other); }
+  Card &operator=(Card &&other) {
+    if (this != &other) {
+      Constraint::operator=(other);
+      moveFrom(other);
+    }
+    return *this;
+  }
+
+  // The coefficients are all 1, so their sum, maximum and GCD follow from
+  // the number of literals.
+  int64_t coeffSum() const { return _lits.size(); }
+  int64_t coeffMax() const { return _lits.size() > 0; }
+  int64_t coeffGcd() const { return _lits.size() > 0; }
+
+  TermView view(bool negated = false) {
+    return TermView(_lits, NULL, coeffSum(), coeffMax(), coeffGcd(), negated);
+  }
+
   void print() {
-    printf("* Card[%d]: ", _id);
+    printf("* Card[%" PRId64 "]: ", _id);
 
     for (int i = 0; i < _lits.size(); i++) {
       if (sign(_lits[i]))
@@ -95,27 +160,123 @@ public:
   vec<Lit> _lits;
   int64_t _rhs;
   pb_Sign _sign;
-  uint _id;
+  int64_t _id;
+
+protected:
+  void moveFrom(Card &other) {
+    other._lits.moveTo(_lits);
+    _rhs = other._rhs;
+    _sign = other._sign;
+    _id = other._id;
+  }
+};
+
+// Arbitrary precision coefficients and rhs of a PB constraint whose
+// coefficient sum does not fit into 64 bits.
+struct PBBig {
+  std::vector<mpz_class> coeffs;
+  mpz_class rhs;
+
+  // Value of x saturated to the range of int64_t.
+  static int64_t saturate(const mpz_class &x) {
+    if (x.fits_slong_p())
+      return x.get_si();
+    return x < 0 ? INT64_MIN : INT64_MAX;
+  }
 };
 
 // PB constraint. The constraint sign is encoded in the structure.
+// If _big is set it holds the exact coefficients and rhs, and _coeffs and _rhs
+// only hold their values saturated to 64 bits.
 class PB : public Constraint {
 
 public:
   PB(vec<Lit> &lits, vec<int64_t> &coeffs, int64_t rhs,
-     pb_Sign s = _PB_LESS_OR_EQUAL_, uint id = 0) {
+     pb_Sign s = _PB_LESS_OR_EQUAL_, int64_t id = 0) {
+    // leave room for the literal that reifies the constraint
+    _lits.capacity(lits.size() + 1);
+    _coeffs.capacity(coeffs.size() + 1);
     lits.copyTo(_lits);
     coeffs.copyTo(_coeffs);
     _rhs = rhs;
     _sign = s;
     _id = id;
+    _big = NULL;
+    updateCoeffStats();
   }
 
   PB() {
     _rhs = 0;
     _sign = _PB_LESS_OR_EQUAL_;
+    _big = NULL;
+    _coeffSum = _coeffMax = _coeffGcd = 0;
+  }
+  ~PB() { delete _big; }
+
+  // PB owns _big, so it is handed over, never copied: a moved-from
+  // constraint has no terms and no _big.
+  PB(const PB &) = delete;
+  PB &operator=(const PB &) = delete;
+  PB(PB &&other) : Constraint(other), _big(NULL) { moveFrom(other); }
+  PB &operator=(PB &&other) {
+    if (this != &other) {
+      Constraint::operator=(other);
+      moveFrom(other);
+    }
+    return *this;
+  }
+
+  int64_t coeffSum() const { return _coeffSum; }
+  int64_t coeffMax() const { return _coeffMax; }
+  int64_t coeffGcd() const { return _coeffGcd; }
+
+  TermView view(bool negated = false) {
+    return TermView(_lits, _coeffs, _coeffSum, _coeffMax, _coeffGcd, negated);
+  }
+
+  // Removes all terms but keeps their memory, so that a temporary constraint
+  // can be reused without allocating.
+  void clear() {
+    assert(_big == NULL);
+    _lits.clear();
+    _coeffs.clear();
+    _rhs = 0;
+    _coeffSum = _coeffMax = _coeffGcd = 0;
+  }
+
+  static int64_t gcd(int64_t a, int64_t b) {
+    while (b != 0) {
+      int64_t t = a % b;
+      a = b;
+      b = t;
+    }
+    return a;
+  }
+
+  // Recomputes the cached sum, maximum and GCD of the coefficients. Must be
+  // called after _coeffs is changed other than with addProduct.
+  void updateCoeffStats() {
+    _coeffSum = _coeffMax = _coeffGcd = 0;
+    for (int i = 0; i < _coeffs.size(); i++)
+      addCoeffStats(_coeffs[i]);
+  }
+
+  // Moves the arbitrary precision coefficients back to _coeffs and _rhs if
+  // their sum plus the rhs fits into 64 bits.
+  void shrinkBig() {
+    assert(_big != NULL);
+    mpz_class bound = _big->rhs + 1;
+    for (size_t i = 0; i < _big->coeffs.size(); i++)
+      bound += _big->coeffs[i];
+    if (!bound.fits_slong_p())
+      return;
+    for (int i = 0; i < _coeffs.size(); i++)
+      _coeffs[i] = _big->coeffs[i].get_si();
+    _rhs = _big->rhs.get_si();
+    delete _big;
+    _big = NULL;
+    updateCoeffStats();
   }
-  ~PB() {}
 
   void addProduct(Lit l, int64_t c) {
     _coeffs.push();
@@ -128,6 +289,7 @@ public:
       _lits[_lits.size() - 1] = ~l;
       _rhs += -c;
     }
+    addCoeffStats(_coeffs.last());
   }
 
   void addRHS(int64_t rhs) { _rhs += rhs; }
@@ -193,53 +355,42 @@ public:
     return true;
   }
 
-  void print(std::stringstream &ss, varMap &v) {
-    for (int i = 0; i < _coeffs.size(); i++) {
-      ss << _coeffs[i] << " ";
-      if (sign(_lits[i]))
-        ss << "~";
-      varMap::const_iterator iter = v.find(var(_lits[i]));
-      if (iter != v.end())
-        ss << "x" << iter->second << " ";
-      else
-        ss << "x" << (var(_lits[i]) + 1) << " ";
-    }
-    if (_sign == _PB_EQUAL_)
-      ss << "= ";
-    else if (_sign == _PB_LESS_OR_EQUAL_)
-      ss << "<= ";
-    else if (_sign == _PB_GREATER_OR_EQUAL_)
-      ss << ">= ";
-    ss << _rhs << " ;";
-  }
-
-  std::string print(varMap &v) {
-    std::stringstream ss;
-    for (int i = 0; i < _coeffs.size(); i++) {
-      ss << _coeffs[i] << " ";
-      if (sign(_lits[i]))
-        ss << "~";
-      varMap::const_iterator iter = v.find(var(_lits[i]));
-      if (iter != v.end())
-        ss << "x" << iter->second << " ";
-      else
-        ss << "x" << (var(_lits[i]) + 1) << " ";
-    }
-    if (_sign == _PB_EQUAL_)
-      ss << "= ";
-    else if (_sign == _PB_LESS_OR_EQUAL_)
-      ss << "<= ";
-    else if (_sign == _PB_GREATER_OR_EQUAL_)
-      ss << ">= ";
-    ss << _rhs << " ;";
-    return ss.str();
-  }
-  
   vec<int64_t> _coeffs;
   vec<Lit> _lits;
   int64_t _rhs;
   pb_Sign _sign;
-  uint _id;
+  int64_t _id;
+  PBBig *_big;
+
+  // Sum (saturated to INT64_MAX), maximum and GCD of _coeffs. Only
+  // meaningful if _big is NULL.
+  int64_t _coeffSum;
+  int64_t _coeffMax;
+  int64_t _coeffGcd;
+
+protected:
+  void moveFrom(PB &other) {
+    other._coeffs.moveTo(_coeffs);
+    other._lits.moveTo(_lits);
+    _rhs = other._rhs;
+    _sign = other._sign;
+    _id = other._id;
+    delete _big;
+    _big = other._big;
+    other._big = NULL;
+    _coeffSum = other._coeffSum;
+    _coeffMax = other._coeffMax;
+    _coeffGcd = other._coeffGcd;
+    other._coeffSum = other._coeffMax = other._coeffGcd = 0;
+  }
+
+  void addCoeffStats(int64_t c) {
+    _coeffSum = c > INT64_MAX - _coeffSum ? INT64_MAX : _coeffSum + c;
+    if (c > _coeffMax)
+      _coeffMax = c;
+    if (_coeffGcd != 1)
+      _coeffGcd = gcd(_coeffGcd, c);
+  }
 };
 
 class PBObjFunction {
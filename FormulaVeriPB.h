@@ -33,8 +33,10 @@
 
 #include "FormulaPB.h"
 #include "MaxTypes.h"
+#include "OutputStream.h"
 
 #include <map>
+#include <vector>
 
 using NSPACE::Lit;
 using NSPACE::Var;
@@ -44,163 +46,326 @@ namespace openwbo {
 
 typedef std::map<int, int> varMap;
 
-class PBP {
+/*! Text of the literals in the proof, built once per variable.
+ *
+ * The text of variable v is "~x<id> " with the output id of v, and the text
+ * of its positive literal is the same without the leading '~', so that a
+ * literal is written with a single copy.
+ */
+class LitNames {
 public:
-  PBP() { _ctrid = -1; }
-  ~PBP() {}
+  int nVars() const { return _ends.size(); }
+
+  /*! Appends the next variable, whose output id is 'id'. */
+  void add(int32_t id) {
+    char digits[16];
+    int size = OutputStream::formatUInt(digits, id);
+    _text.push_back('~');
+    _text.push_back('x');
+    _text.insert(_text.end(), digits, digits + size);
+    _text.push_back(' ');
+    _ends.push_back(_text.size());
+  }
 
-  virtual std::string print(varMap& v) = 0;
-  virtual void print(std::stringstream &ss, varMap& v) = 0;
-  int _ctrid;
+  /*! Writes l followed by a space. */
+  void write(OutputStream &out, Lit l) const {
+    int v = NSPACE::var(l);
+    int64_t begin = v == 0 ? 0 : _ends[v - 1];
+    if (!NSPACE::sign(l))
+      begin++;
+    out.write(&_text[begin], _ends[v] - begin);
+  }
+
+private:
+  std::vector<char> _text;    //<! Text of the negative literals.
+  std::vector<int64_t> _ends; //<! End of the text of each variable.
 };
 
-// used for the definition of the auxiliary variables
-class PBPred : public PBP {
+/*! Proof steps of the constraint that is currently encoded.
+ *
+ * Each step is a record of bytes in a single buffer: an opcode byte followed
+ * by the operands as LEB128 varints, so that the 64-bit ids of a proof take
+ * as little space as their value needs. The records are only turned into
+ * VeriPB text when the proof is written.
+ *
+ *   p:   items of the polish notation, each an item opcode and its operands,
+ *        terminated by _P_END_
+ *   red: witness variable, witness value, sign, rhs, number of terms,
+ *        (coeff, lit) pairs
+ *   u:   number of literals, literals of the clause
+ *
+ * Signed operands (ids, coefficients and the rhs) are zigzag encoded.
+ */
+class ProofBuffer {
 public:
-  PBPred(int ctrid, PB *ctr, int v, int value) {
-    _ctrid = ctrid;
-    _ctr = ctr;
-    _v = v;
-    _value = value;
+  enum { _PROOF_P_ = 0, _PROOF_RED_, _PROOF_U_ };
+  enum {
+    _P_ADD_ = 0,  // c +
+    _P_ADD2_,     // c1 c2 +
+    _P_MUL_,      // c factor *
+    _P_MUL_POW2_, // c 2^exponent *
+    _P_DIV_,      // divisor d
+    _P_DIV2_,     // c divisor d
+    _P_SAT_,      // s
+    _P_SAT1_,     // c s
+    _P_END_
+  };
+
+  /*! Starts a record and returns its position. */
+  int64_t begin(int op) {
+    _data.push_back(op);
+    return _data.size() - 1;
   }
-  PBPred() {}
-  ~PBPred() {}
 
-  void print(std::stringstream &ss, varMap& v) {
-    ss << "red ";
-    _ctr->print(ss, v);
-    ss << " x" << _v << " -> " << _value << "\n";
+  void pushOp(int op) { _data.push_back(op); }
+
+  void push(int64_t w) {
+    uint64_t u = ((uint64_t)w << 1) ^ (uint64_t)(w >> 63);
+    while (u >= 0x80) {
+      _data.push_back((uint8_t)(u | 0x80));
+      u >>= 7;
+    }
+    _data.push_back((uint8_t)u);
+  }
+  void push(int64_t w1, int64_t w2) {
+    push(w1);
+    push(w2);
   }
 
-  std::string print(varMap& v) {
-    std::string wit =
-        " x" + std::to_string(_v) + " -> " + std::to_string(_value);
-    std::string s = "red " + _ctr->print(v) + wit;
-    return s;
+  void clear() { _data.clear(); }
+  int64_t size() const { return _data.size(); }
+
+  /*! Writes the record at pos in VeriPB format and returns the position of
+   * the next record. */
+  int64_t print(OutputStream &out, int64_t pos, const LitNames &names) const {
+    const uint8_t *w = &_data[pos];
+    int op = *w++;
+    if (op == _PROOF_P_) {
+      out.put('p');
+      for (int item = *w++; item != _P_END_; item = *w++) {
+        switch (item) {
+        case _P_ADD_:
+          writeOperand(out, read(w));
+          out.write(" +", 2);
+          break;
+        case _P_ADD2_:
+          writeOperand(out, read(w));
+          writeOperand(out, read(w));
+          out.write(" +", 2);
+          break;
+        case _P_MUL_:
+          writeOperand(out, read(w));
+          writeOperand(out, read(w));
+          out.write(" *", 2);
+          break;
+        case _P_MUL_POW2_: {
+          writeOperand(out, read(w));
+          // multiplication by 2^exponent, which may not fit into 64 bits
+          int64_t exponent = read(w);
+          if (exponent < 63)
+            writeOperand(out, (int64_t)1 << exponent);
+          else {
+            out.put(' ');
+            out.write(mpz_class(mpz_class(1) << exponent).get_str().c_str());
+          }
+          out.write(" *", 2);
+          break;
+        }
+        case _P_DIV_:
+          writeOperand(out, read(w));
+          out.write(" d", 2);
+          break;
+        case _P_DIV2_:
+          writeOperand(out, read(w));
+          writeOperand(out, read(w));
+          out.write(" d", 2);
+          break;
+        case _P_SAT_:
+          out.write(" s", 2);
+          break;
+        case _P_SAT1_:
+          writeOperand(out, read(w));
+          out.write(" s", 2);
+          break;
+        default:
+          assert(false);
+        }
+      }
+      out.put('\n');
+    } else if (op == _PROOF_RED_) {
+      int64_t witness = read(w), value = read(w);
+      int64_t sign = read(w), rhs = read(w);
+      out.write("red ", 4);
+      for (int64_t n = read(w); n > 0; n--) {
+        out.writeInt(read(w));
+        out.put(' ');
+        names.write(out, NSPACE::toLit(read(w)));
+      }
+      if (sign == _PB_EQUAL_)
+        out.write("= ", 2);
+      else if (sign == _PB_LESS_OR_EQUAL_)
+        out.write("<= ", 3);
+      else if (sign == _PB_GREATER_OR_EQUAL_)
+        out.write(">= ", 3);
+      out.writeInt(rhs);
+      out.write(" ; ", 3);
+      names.write(out, NSPACE::mkLit(witness));
+      out.write("-> ", 3);
+      out.writeInt(value);
+      out.put('\n');
+    } else {
+      assert(op == _PROOF_U_);
+      out.write("u ", 2);
+      for (int64_t n = read(w); n > 0; n--) {
+        out.write("1 ", 2);
+        names.write(out, NSPACE::toLit(read(w)));
+      }
+      out.write(">= 1 ;\n", 7);
+    }
+    return w - &_data[0];
   }
 
-  PB *_ctr;
-  int _v;
-  int _value;
+protected:
+  static void writeOperand(OutputStream &out, int64_t w) {
+    out.put(' ');
+    out.writeInt(w);
+  }
+
+  /*! Decodes the operand at w and advances w past it. */
+  static int64_t read(const uint8_t *&w) {
+    uint64_t u = 0;
+    for (int shift = 0;; shift += 7) {
+      uint8_t b = *w++;
+      u |= (uint64_t)(b & 0x7f) << shift;
+      if (b < 0x80)
+        break;
+    }
+    return (int64_t)(u >> 1) ^ -(int64_t)(u & 1);
+  }
+
+  std::vector<uint8_t> _data;
 };
 
-// this is only useful for debugging and not required for the proof
-class PBPe : public PBP {
+// used for the definition of the auxiliary variables
+class PBPred {
 public:
-  PBPe(int ctrid, int id, PB *ctr) {
+  PBPred(int64_t ctrid, PB *ctr, Var v, int value) {
     _ctrid = ctrid;
-    _id = id;
     _ctr = ctr;
+    _v = v;
+    _value = value;
+    _sum = 0;
+    for (int i = 0; i < ctr->_coeffs.size(); i++) {
+      if (var(ctr->_lits[i]) != v)
+        _sum += ctr->_coeffs[i];
+    }
   }
+  PBPred() {}
 
-  void print(std::stringstream &ss, varMap& v){
-    ss << "e " << _id << " ";
-    _ctr->print(ss, v);
-    ss << "\n";
-  }
-
-  std::string print(varMap& v) {
-    std::string s = "e " + std::to_string(_id) + " " + _ctr->print(v);
-    return s;
+  /*! Appends the step to the proof buffer and returns its position. */
+  int64_t write(ProofBuffer &buffer) const {
+    int64_t pos = buffer.begin(ProofBuffer::_PROOF_RED_);
+    buffer.push(_v, _value);
+    buffer.push(_ctr->_sign, _ctr->_rhs);
+    buffer.push(_ctr->_coeffs.size());
+    for (int i = 0; i < _ctr->_coeffs.size(); i++)
+      buffer.push(_ctr->_coeffs[i], NSPACE::toInt(_ctr->_lits[i]));
+    return pos;
   }
 
-  PB *_ctr;
-  int _id;
+  int64_t _ctrid;
+  PB *_ctr;     //!< Reified constraint, only valid until the step is written.
+  Var _v;        //!< Witness variable, printed with its output id.
+  int _value;
+  int64_t _sum; //!< Sum of the coefficients of the constraint besides x_v.
 };
 
-class PBPp : public PBP {
+// Builds a 'p' step in place in the proof buffer. No other step may be added
+// to the buffer until this one is added to the formula.
+class PBPp {
 public:
-  PBPp(int ctrid) {
+  PBPp(ProofBuffer &buffer, int64_t ctrid) : _buffer(buffer) {
     _ctrid = ctrid;
-    _p << "p";
+    _pos = buffer.begin(ProofBuffer::_PROOF_P_);
   }
 
-  // id
-  // stack ids, operators
-  // or string as you go; sstream
-
-  // TODO: worth it to make this more generic?
   // no error handling is currently enforced
-  void addition(int c1, int c2) { _p << " " << c1 << " " << c2 << " +"; }
+  void addition(int64_t c1, int64_t c2) {
+    _buffer.pushOp(ProofBuffer::_P_ADD2_);
+    _buffer.push(c1, c2);
+  }
 
-  void addition(int c1) { _p << " " << c1 << " +"; }
+  void addition(int64_t c1) {
+    _buffer.pushOp(ProofBuffer::_P_ADD_);
+    _buffer.push(c1);
+  }
 
-  void multiplication(int c1, int factor) {
+  void multiplication(int64_t c1, int64_t factor) {
     assert(factor > 0);
-    _p << " " << c1 << " " << factor << " *";
+    _buffer.pushOp(ProofBuffer::_P_MUL_);
+    _buffer.push(c1, factor);
   }
 
-  void division(int c1, int divisor) {
-    assert(divisor > 0);
-    _p << " " << c1 << " " << divisor << " d";
+  // multiplication by 2^exponent, which may not fit into 64 bits
+  void multiplicationPow2(int64_t c1, int exponent) {
+    assert(exponent >= 0);
+    _buffer.pushOp(ProofBuffer::_P_MUL_POW2_);
+    _buffer.push(c1, exponent);
   }
 
-  void division(int divisor) { _p << " " << divisor << " d"; }
+  void division(int64_t c1, int64_t divisor) {
+    assert(divisor > 0);
+    _buffer.pushOp(ProofBuffer::_P_DIV2_);
+    _buffer.push(c1, divisor);
+  }
 
-  void saturation(int c1) { _p << " " << c1 << " s"; }
+  void division(int64_t divisor) {
+    _buffer.pushOp(ProofBuffer::_P_DIV_);
+    _buffer.push(divisor);
+  }
 
-  void saturation() { _p << " s"; }
+  void saturation(int64_t c1) {
+    _buffer.pushOp(ProofBuffer::_P_SAT1_);
+    _buffer.push(c1);
+  }
 
-  // TODO: should we support literal axioms, weakening?
+  void saturation() { _buffer.pushOp(ProofBuffer::_P_SAT_); }
 
-  void print(std::stringstream &ss, varMap& v){
-    ss << _p.str() << "\n";
+  /*! Finishes the step and returns its position. */
+  int64_t write(ProofBuffer &buffer) const {
+    assert(&buffer == &_buffer);
+    buffer.pushOp(ProofBuffer::_P_END_);
+    return _pos;
   }
 
-  std::string print(varMap& v) { return _p.str(); }
+  int64_t _ctrid;
 
 private:
-  std::stringstream _p;
+  ProofBuffer &_buffer;
+  int64_t _pos;
 };
 
 // this will be automatically translated from the CNF encoding and do not need
 // to be added
-class PBPu : public PBP {
+class PBPu {
 public:
-  PBPu(int ctrid, vec<Lit> &clause) {
-    clause.copyTo(_clause);
+  PBPu(int64_t ctrid, vec<Lit> &clause) : _clause(clause) {
     _ctrid = ctrid;
   }
 
-  void print(std::stringstream &ss, varMap& v){
-    ss << "u ";
-    int rhs = 1;
-    for (int i = 0; i < _clause.size(); i++) {
-      if (sign(_clause[i])) {
-        ss << "1 ~";
-        // rhs--;
-      } else
-        ss << "1 ";
-      varMap::const_iterator iter = v.find(var(_clause[i]));
-      if (iter != v.end())
-        ss << "x" << iter->second << " ";
-      else
-        ss << "x" << (var(_clause[i]) + 1) << " ";
-    }
-    ss << ">= " << rhs << " ;\n";
-  }
-
-  std::string print(varMap& v) {
-    std::stringstream ss;
-    ss << "u ";
-    int rhs = 1;
-    for (int i = 0; i < _clause.size(); i++) {
-      if (sign(_clause[i])) {
-        ss << "1 ~";
-        // rhs--;
-      } else
-        ss << "1 ";
-      varMap::const_iterator iter = v.find(var(_clause[i]));
-      if (iter != v.end())
-        ss << "x" << iter->second << " ";
-      else
-        ss << "x" << (var(_clause[i]) + 1) << " ";
-    }
-    ss << ">= " << rhs << " ;";
-    return ss.str();
+  /*! Appends the step to the proof buffer and returns its position. */
+  int64_t write(ProofBuffer &buffer) const {
+    int64_t pos = buffer.begin(ProofBuffer::_PROOF_U_);
+    buffer.push(_clause.size());
+    for (int i = 0; i < _clause.size(); i++)
+      buffer.push(NSPACE::toInt(_clause[i]));
+    return pos;
   }
 
-  vec<Lit> _clause;
+  int64_t _ctrid;
+
+private:
+  vec<Lit> &_clause;
 };
 
 } // namespace openwbo
@@ -0,0 +1,302 @@
+/*!
+ * \author Ruben Martins - rubenm@andrew.cmu.edu
+ *
+ * @section LICENSE
+ *
+ * VeritasPBLib, Copyright (c) 2021-2022, Stephan Gocht, Andy Oertel
+ *                                        Ruben Martins, Jakob Nordstrom
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+#include "InputStream.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#ifdef HAS_LZMA
+#include <lzma.h>
+#endif
+
+#ifdef HAS_ZSTD
+#include <zstd.h>
+#endif
+
+using namespace openwbo;
+
+// Size of the buffer for compressed input.
+#define _INPUT_BUFFER_SIZE_ (1 << 18)
+
+InputStream::InputStream(int fd, const unsigned char *head, int headSize)
+    : _fd(fd), _headSize(headSize), _headPos(0) {
+  memcpy(_head, head, headSize);
+}
+
+ssize_t InputStream::readRaw(char *buf, size_t size) {
+  if (_headPos < _headSize) {
+    size_t n = _headSize - _headPos;
+    if (n > size)
+      n = size;
+    memcpy(buf, _head + _headPos, n);
+    _headPos += n;
+    return n;
+  }
+  ssize_t n;
+  do {
+    n = ::read(_fd, buf, size);
+  } while (n < 0 && errno == EINTR);
+  return n;
+}
+
+int InputStream::detect(int fd, unsigned char *head, int *headSize) {
+  *headSize = 0;
+  while (*headSize < _INPUT_HEAD_SIZE_) {
+    ssize_t n = ::read(fd, head + *headSize, _INPUT_HEAD_SIZE_ - *headSize);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0)
+      return -1;
+    if (n == 0)
+      break;
+    *headSize += n;
+  }
+
+  static const unsigned char gzip[] = {0x1f, 0x8b};
+  static const unsigned char xz[] = {0xfd, '7', 'z', 'X', 'Z', 0x00};
+  static const unsigned char zstd[] = {0x28, 0xb5, 0x2f, 0xfd};
+  if (*headSize >= 2 && memcmp(head, gzip, 2) == 0)
+    return _INPUT_GZIP_;
+  if (*headSize >= 6 && memcmp(head, xz, 6) == 0)
+    return _INPUT_XZ_;
+  if (*headSize >= 4 && memcmp(head, zstd, 4) == 0)
+    return _INPUT_ZSTD_;
+  return _INPUT_PLAIN_;
+}
+
+const char *InputStream::formatName(int format) {
+  switch (format) {
+  case _INPUT_GZIP_:
+    return "gzip";
+  case _INPUT_XZ_:
+    return "xz";
+  case _INPUT_ZSTD_:
+    return "zstd";
+  default:
+    return "plain";
+  }
+}
+
+namespace {
+
+class PlainInputStream : public InputStream {
+public:
+  PlainInputStream(int fd, const unsigned char *head, int headSize)
+      : InputStream(fd, head, headSize) {}
+
+  ssize_t read(char *buf, size_t size) { return readRaw(buf, size); }
+};
+
+class GzipInputStream : public InputStream {
+public:
+  GzipInputStream(int fd, const unsigned char *head, int headSize)
+      : InputStream(fd, head, headSize), _inputEnd(false), _streamEnd(false) {
+    memset(&_z, 0, sizeof(_z));
+    // 15 + 32: maximum window size with automatic gzip/zlib header detection
+    _valid = inflateInit2(&_z, 15 + 32) == Z_OK;
+  }
+
+  ~GzipInputStream() {
+    if (_valid)
+      inflateEnd(&_z);
+  }
+
+  ssize_t read(char *buf, size_t size) {
+    if (!_valid)
+      return -1;
+    _z.next_out = (Bytef *)buf;
+    _z.avail_out = size;
+
+    while (_z.avail_out > 0) {
+      if (_z.avail_in == 0 && !_inputEnd) {
+        ssize_t n = readRaw((char *)_in, _INPUT_BUFFER_SIZE_);
+        if (n < 0)
+          return -1;
+        if (n == 0)
+          _inputEnd = true;
+        _z.next_in = _in;
+        _z.avail_in = n;
+      }
+
+      if (_streamEnd) {
+        // gzip files may consist of several concatenated members
+        if (_z.avail_in == 0)
+          break;
+        if (inflateReset(&_z) != Z_OK)
+          return -1;
+        _streamEnd = false;
+      }
+
+      if (_z.avail_in == 0 && _inputEnd)
+        return -1; // truncated input
+
+      int ret = inflate(&_z, Z_NO_FLUSH);
+      if (ret == Z_STREAM_END)
+        _streamEnd = true;
+      else if (ret != Z_OK && ret != Z_BUF_ERROR)
+        return -1;
+    }
+    return size - _z.avail_out;
+  }
+
+protected:
+  z_stream _z;
+  unsigned char _in[_INPUT_BUFFER_SIZE_];
+  bool _valid;
+  bool _inputEnd;
+  bool _streamEnd;
+};
+
+#ifdef HAS_LZMA
+class XzInputStream : public InputStream {
+public:
+  XzInputStream(int fd, const unsigned char *head, int headSize)
+      : InputStream(fd, head, headSize), _inputEnd(false), _streamEnd(false) {
+    lzma_stream init = LZMA_STREAM_INIT;
+    _s = init;
+    _valid = lzma_stream_decoder(&_s, UINT64_MAX, LZMA_CONCATENATED) ==
+             LZMA_OK;
+  }
+
+  ~XzInputStream() { lzma_end(&_s); }
+
+  ssize_t read(char *buf, size_t size) {
+    if (!_valid)
+      return -1;
+    _s.next_out = (uint8_t *)buf;
+    _s.avail_out = size;
+
+    while (_s.avail_out > 0 && !_streamEnd) {
+      if (_s.avail_in == 0 && !_inputEnd) {
+        ssize_t n = readRaw((char *)_in, _INPUT_BUFFER_SIZE_);
+        if (n < 0)
+          return -1;
+        if (n == 0)
+          _inputEnd = true;
+        _s.next_in = _in;
+        _s.avail_in = n;
+      }
+
+      lzma_ret ret = lzma_code(&_s, _inputEnd ? LZMA_FINISH : LZMA_RUN);
+      if (ret == LZMA_STREAM_END)
+        _streamEnd = true;
+      else if (ret != LZMA_OK)
+        return -1;
+    }
+    return size - _s.avail_out;
+  }
+
+protected:
+  lzma_stream _s;
+  uint8_t _in[_INPUT_BUFFER_SIZE_];
+  bool _valid;
+  bool _inputEnd;
+  bool _streamEnd;
+};
+#endif
+
+#ifdef HAS_ZSTD
+class ZstdInputStream : public InputStream {
+public:
+  ZstdInputStream(int fd, const unsigned char *head, int headSize)
+      : InputStream(fd, head, headSize), _inputEnd(false), _frameEnd(true) {
+    _in.src = _buf;
+    _in.size = 0;
+    _in.pos = 0;
+    _ds = ZSTD_createDStream();
+    _valid = _ds != NULL && !ZSTD_isError(ZSTD_initDStream(_ds));
+  }
+
+  ~ZstdInputStream() { ZSTD_freeDStream(_ds); }
+
+  ssize_t read(char *buf, size_t size) {
+    if (!_valid)
+      return -1;
+    ZSTD_outBuffer out = {buf, size, 0};
+
+    while (out.pos < out.size) {
+      if (_in.pos == _in.size && !_inputEnd) {
+        ssize_t n = readRaw(_buf, _INPUT_BUFFER_SIZE_);
+        if (n < 0)
+          return -1;
+        if (n == 0)
+          _inputEnd = true;
+        _in.size = n;
+        _in.pos = 0;
+      }
+
+      if (_in.pos == _in.size && _inputEnd) {
+        if (!_frameEnd)
+          return -1; // truncated input
+        break;
+      }
+
+      size_t ret = ZSTD_decompressStream(_ds, &out, &_in);
+      if (ZSTD_isError(ret))
+        return -1;
+      // 0 means that a frame is completely decoded and flushed
+      _frameEnd = ret == 0;
+    }
+    return out.pos;
+  }
+
+protected:
+  ZSTD_DStream *_ds;
+  ZSTD_inBuffer _in;
+  char _buf[_INPUT_BUFFER_SIZE_];
+  bool _valid;
+  bool _inputEnd;
+  bool _frameEnd;
+};
+#endif
+
+} // namespace
+
+InputStream *InputStream::create(int format, int fd, const unsigned char *head,
+                                 int headSize) {
+  switch (format) {
+  case _INPUT_PLAIN_:
+    return new PlainInputStream(fd, head, headSize);
+  case _INPUT_GZIP_:
+    return new GzipInputStream(fd, head, headSize);
+#ifdef HAS_LZMA
+  case _INPUT_XZ_:
+    return new XzInputStream(fd, head, headSize);
+#endif
+#ifdef HAS_ZSTD
+  case _INPUT_ZSTD_:
+    return new ZstdInputStream(fd, head, headSize);
+#endif
+  default:
+    return NULL;
+  }
+}
@@ -0,0 +1,81 @@
+/*!
+ * \author Ruben Martins - rubenm@andrew.cmu.edu
+ *
+ * @section LICENSE
+ *
+ * VeritasPBLib, Copyright (c) 2021-2022, Stephan Gocht, Andy Oertel
+ *                                        Ruben Martins, Jakob Nordstrom
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+#ifndef InputStream_h
+#define InputStream_h
+
+#include <stddef.h>
+#include <sys/types.h>
+
+namespace openwbo {
+
+enum InputFormat { _INPUT_PLAIN_, _INPUT_GZIP_, _INPUT_XZ_, _INPUT_ZSTD_ };
+
+/*! Sequential reader over a file descriptor that transparently decompresses
+ * gzip, xz and zstd inputs. The compression format is detected from the magic
+ * bytes at the start of the input, so no seeking is required.
+ */
+class InputStream {
+
+public:
+  virtual ~InputStream() {}
+
+  /*! Reads the first bytes of 'fd' and returns the detected format. The bytes
+   * are kept in 'head' (at least _INPUT_HEAD_SIZE_ bytes) and must be passed to
+   * create. Returns -1 on a read error. */
+  static int detect(int fd, unsigned char *head, int *headSize);
+
+  /*! Creates a reader for the given format. Returns NULL if the format is not
+   * supported by this build. */
+  static InputStream *create(int format, int fd, const unsigned char *head,
+                             int headSize);
+
+  static const char *formatName(int format);
+
+  /*! Reads up to 'size' bytes of decompressed input. Returns the number of
+   * bytes read, 0 at the end of the input or -1 on an error. */
+  virtual ssize_t read(char *buf, size_t size) = 0;
+
+  static const int _INPUT_HEAD_SIZE_ = 6;
+
+protected:
+  InputStream(int fd, const unsigned char *head, int headSize);
+
+  // Reads raw (compressed) bytes, starting with the detected head.
+  ssize_t readRaw(char *buf, size_t size);
+
+  int _fd;
+  unsigned char _head[_INPUT_HEAD_SIZE_];
+  int _headSize;
+  int _headPos;
+};
+
+} // namespace openwbo
+
+#endif
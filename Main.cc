@@ -35,6 +35,7 @@
 #include <signal.h>
 #include <zlib.h>
 
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <map>
@@ -48,10 +49,12 @@
 #include "MaxTypes.h"
 #include "ParserMaxSAT.h"
 #include "ParserPB.h"
+#include "Snapshot.h"
 #include "encodings/Encodings.h"
 
 using NSPACE::BoolOption;
 using NSPACE::cpuTime;
+using NSPACE::Int64Option;
 using NSPACE::IntOption;
 using NSPACE::IntRange;
 using NSPACE::OutOfMemoryException;
@@ -97,6 +100,51 @@ int main(int argc, char **argv) {
   BoolOption proof("VeritasPBLib", "proof",
                    "Stores information and writes the proof to file", 1);
 
+  StringOption cnf_file("VeritasPBLib", "cnf",
+                         "Output CNF file (default: input name with .cnf).\n");
+
+  StringOption pbp_file("VeritasPBLib", "pbp",
+                        "Output proof file (default: input name with .pbp).\n");
+
+  IntOption parse_threads("VeritasPBLib", "parse-threads",
+                          "Number of threads used to parse uncompressed "
+                          "files.\n",
+                          1, IntRange(1, 256));
+
+  IntOption input_format("VeritasPBLib", "format",
+                         "Input format (0=by extension, 1=OPB, "
+                         "2=DIMACS CNF/WCNF, 3=WBO).\n",
+                         0, IntRange(0, 3));
+
+  Int64Option upper_bound("VeritasPBLib", "ub",
+                          "Upper bound on the cost of the soft clauses or "
+                          "constraints, encoded as a PB constraint "
+                          "(-1=none).\n",
+                          -1, NSPACE::Int64Range(-1, INT64_MAX));
+
+  StringOption opb_file("VeritasPBLib", "opb",
+                        "Output OPB file of MaxSAT and WBO inputs (default: "
+                        "input name with .opb).\n");
+
+  StringOption save_snapshot("VeritasPBLib", "save-snapshot",
+                             "Writes the parsed formula to a binary snapshot "
+                             "file.\n");
+
+  StringOption load_snapshot("VeritasPBLib", "load-snapshot",
+                             "Reads the formula from a binary snapshot file "
+                             "instead of parsing the input.\n");
+
+  BoolOption dedup("VeritasPBLib", "dedup",
+                   "Drops duplicate hard clauses from the CNF and the proof",
+                   0);
+
+  StringOption compress("VeritasPBLib", "compress",
+                        "Compresses the CNF, proof and OPB files (gz or "
+                        "zstd).\n");
+
+  BoolOption compress_thread("VeritasPBLib", "compress-thread",
+                             "Compresses the output on a separate thread", 0);
+
   parseOptions(argc, argv, true);
 
   double initial_time = cpuTime();
@@ -104,22 +152,143 @@ int main(int argc, char **argv) {
   signal(SIGXCPU, SIGINT_exit);
   signal(SIGTERM, SIGINT_exit);
 
-  if (argc == 1) {
-    printf("c Warning: no filename.\n");
+  // the output of a snapshot is named after the input if it is given
+  const char *input = argc == 1 ? NULL : argv[1];
+  if (load_snapshot != NULL && input == NULL)
+    input = load_snapshot;
+  if (input == NULL) {
+    printf("c Warning: no filename, reading from standard input.\n");
   }
 
-  gzFile in = (argc == 1) ? gzdopen(0, "rb") : gzopen(argv[1], "rb");
-  if (in == NULL)
-    printf("c ERROR! Could not open file: %s\n",
-           argc == 1 ? "<stdin>" : argv[1]),
-        printf("s UNKNOWN\n"), exit(_ERROR_);
+  std::string filename(input == NULL ? "stdin" : input);
+  // instance.opb.gz is written to instance.cnf as well
+  size_t ext = filename.find_last_of(".");
+  if (ext != std::string::npos &&
+      (filename.compare(ext, std::string::npos, ".gz") == 0 ||
+       filename.compare(ext, std::string::npos, ".xz") == 0 ||
+       filename.compare(ext, std::string::npos, ".zst") == 0))
+    filename = filename.substr(0, ext);
+  ext = filename.find_last_of(".");
+  int format = _FORMAT_PB_;
+  if (input_format == 2)
+    format = _FORMAT_MAXSAT_;
+  else if (input_format == 3)
+    format = _FORMAT_WBO_;
+  else if (input_format == 0 && ext != std::string::npos &&
+           load_snapshot == NULL) {
+    if (filename.compare(ext, std::string::npos, ".cnf") == 0 ||
+        filename.compare(ext, std::string::npos, ".wcnf") == 0)
+      format = _FORMAT_MAXSAT_;
+    else if (filename.compare(ext, std::string::npos, ".wbo") == 0)
+      format = _FORMAT_WBO_;
+  }
+  filename = filename.substr(0, ext);
+
+  // compressed output files get the extension of their format by default
+  int output_format = _OUTPUT_PLAIN_;
+  std::string output_ext;
+  if (compress != NULL) {
+    if (std::string(compress) == "gz") {
+      output_format = _OUTPUT_GZIP_;
+      output_ext = ".gz";
+    } else if (std::string(compress) == "zstd") {
+      output_format = _OUTPUT_ZSTD_;
+      output_ext = ".zst";
+    } else {
+      printf("c Error: Unknown output compression %s\n", (const char *)compress);
+      printf("s UNKNOWN\n");
+      exit(_ERROR_);
+    }
+    if (!OutputStream::supported(output_format)) {
+      printf("c Error: This build cannot write %s compressed files\n",
+             (const char *)compress);
+      printf("s UNKNOWN\n");
+      exit(_ERROR_);
+    }
+  }
+
+  // WBO instances are encoded to WCNF
+  std::string cnf_name =
+      cnf_file != NULL
+          ? std::string(cnf_file)
+          : filename + (format == _FORMAT_WBO_ ? ".wcnf" : ".cnf") + output_ext;
+  // instance.cnf is encoded to instance.enc.cnf
+  if (cnf_file == NULL && input != NULL && cnf_name == input)
+    cnf_name = filename + ".enc.cnf" + output_ext;
+  std::string pbp_name =
+      pbp_file != NULL ? std::string(pbp_file) : filename + ".pbp" + output_ext;
+  // the linear formula of an OPB file with products is instance.lin.opb
+  std::string opb_name =
+      opb_file != NULL
+          ? std::string(opb_file)
+          : filename + (format == _FORMAT_PB_ ? ".lin.opb" : ".opb") +
+                output_ext;
+  if (input != NULL &&
+      (cnf_name == input || pbp_name == input ||
+       (proof && opb_name == input) ||
+       (save_snapshot != NULL && std::string(save_snapshot) == input))) {
+    printf("c Error: The output would overwrite the input file %s\n", input);
+    printf("s UNKNOWN\n");
+    exit(_ERROR_);
+  }
 
   MaxSATFormula maxsat_formula;
+  maxsat_formula.setDedupClauses(dedup);
+  maxsat_formula.setOutputCompression(output_format, compress_thread);
   ParserPB parser_pb;
-  parser_pb.parsePBFormula(argv[1], &maxsat_formula);
-  parser_pb.addUnitClauses();
-  maxsat_formula.setFormat(_FORMAT_PB_);
-  gzclose(in);
+  ParserMaxSAT parser_maxsat;
+  ParserPB *parser = &parser_pb;
+  off_t input_size = 0;
+  bool opb_written = false;
+  std::chrono::steady_clock::time_point parse_start =
+      std::chrono::steady_clock::now();
+  if (load_snapshot != NULL) {
+    input_size = Snapshot::load(&maxsat_formula, load_snapshot);
+    // the translated PB formula of a MaxSAT or WBO instance is only written
+    // when the instance is parsed
+    format = maxsat_formula.getFormat();
+    if (format != _FORMAT_PB_ && proof)
+      printf("c Warning: the OPB file of a MaxSAT or WBO instance is not "
+             "written when it is loaded from a snapshot.\n");
+    if (maxsat_formula.hasProducts() && proof)
+      printf("c Warning: the linear PB formula of an OPB file with products "
+             "is not written when it is loaded from a snapshot.\n");
+    if (proof && maxsat_formula.getNames().nArbitrary() > 0) {
+      printf("c Error: The snapshot has variables that are not of the form "
+             "xN, which is required to write the proof\n");
+      printf("s UNKNOWN\n");
+      exit(_ERROR_);
+    }
+    if (format == _FORMAT_WBO_ && cnf_file == NULL)
+      cnf_name = filename + ".wcnf" + output_ext;
+  } else if (format == _FORMAT_MAXSAT_) {
+    parser = &parser_maxsat;
+    parser_maxsat.parseMaxSATFormula(argc == 1 ? NULL : argv[1],
+                                     &maxsat_formula);
+  } else {
+    parser_pb.setThreads(parse_threads);
+    if (format == _FORMAT_WBO_)
+      parser_pb.setWBO();
+    if (proof)
+      parser_pb.setOPBOutput(opb_name);
+    parser_pb.parsePBFormula(argc == 1 ? NULL : argv[1], &maxsat_formula);
+  }
+  std::chrono::duration<double> parse_wall =
+      std::chrono::steady_clock::now() - parse_start;
+  if (load_snapshot == NULL) {
+    if (format == _FORMAT_MAXSAT_)
+      parser_maxsat.relaxSoftClauses(upper_bound);
+    else if (format == _FORMAT_WBO_)
+      parser_pb.relaxSoftConstraints(upper_bound);
+    maxsat_formula.setFormat(format);
+    parser->addUnitClauses();
+    opb_written = parser_pb.closeOPBOutput();
+    input_size = parser->getFileSize();
+  }
+  if (save_snapshot != NULL) {
+    Snapshot::save(&maxsat_formula, save_snapshot);
+    std::cout << "c Snapshot file " << save_snapshot << std::endl;
+  }
 
   printf("c |                                                                "
          "                                       |\n");
@@ -130,13 +299,18 @@ int main(int argc, char **argv) {
 
   printf("c |  Problem Format:  %17s                                         "
          "                          |\n",
-         "PB");
+         format == _FORMAT_MAXSAT_ ? "MaxSAT"
+                                   : format == _FORMAT_WBO_ ? "WBO" : "PB");
 
   printf("c |  Number of variables:  %12d                                    "
          "                               |\n",
          maxsat_formula.nVars());
-  printf("c |  Number of hard clauses:    %7d                                "
-         "                                   |\n",
+  if (format != _FORMAT_PB_)
+    printf("c |  Number of soft clauses:    %7d                                "
+           "                                   |\n",
+           maxsat_formula.nSoft());
+  printf("c |  Number of hard clauses:    %7" PRId64 "                       "
+         "                                            |\n",
          maxsat_formula.nHard());
   printf("c |  Number of cardinality:     %7d                                "
          "                                   |\n",
@@ -149,6 +323,12 @@ int main(int argc, char **argv) {
   printf("c |  Parse time:           %12.2f s                                "
          "                                 |\n",
          parsed_time - initial_time);
+  // wall clock time, the CPU time adds up over the parser threads
+  double parse_seconds = parse_wall.count();
+  printf("c |  Parse throughput:     %12.2f MB/s                             "
+         "                                 |\n",
+         parse_seconds > 0 ? input_size / (1e6 * parse_seconds)
+                           : 0.0);
   printf("c |                                                                "
          "                                       |\n");
 
@@ -205,29 +385,49 @@ int main(int argc, char **argv) {
 
     Encodings encoder(card, pb);
 
+    // the proof of each constraint is written as soon as it is encoded
+    if (proof)
+      maxsat_formula.openPBPFile(pbp_name);
+
     for (int i = 0; i < maxsat_formula.nCard(); i++) {
       Card *c = maxsat_formula.getCardinalityConstraint(i);
       encoder.encode(c, &maxsat_formula, (int)proof==1);
-      maxsat_formula.bumpProofLogId(c->clause_ids.size());
+      maxsat_formula.bumpProofLogId(c->nClauses());
+      if (proof)
+        maxsat_formula.printPBPSegment(c);
+      maxsat_formula.releaseProof(c);
     }
 
     for (int i = 0; i < maxsat_formula.nPB(); i++) {
       PB *p = maxsat_formula.getPBConstraint(i);
       encoder.encode(p, &maxsat_formula, (int)proof==1);
-      maxsat_formula.bumpProofLogId(p->clause_ids.size());
+      maxsat_formula.bumpProofLogId(p->nClauses());
+      if (proof)
+        maxsat_formula.printPBPSegment(p);
+      maxsat_formula.releaseProof(p);
     }
 
-    std::string filename(argv[1]);
-    filename = filename.substr(0, filename.find_last_of("."));
-
-    maxsat_formula.printCNFtoFile(filename);
+    if (format == _FORMAT_WBO_)
+      maxsat_formula.printWCNFtoFile(cnf_name);
+    else
+      maxsat_formula.printCNFtoFile(cnf_name);
     if (proof) {
-      maxsat_formula.printPBPtoFile(filename);
+      maxsat_formula.closePBPFile();
+      if (format == _FORMAT_MAXSAT_ && load_snapshot == NULL) {
+        parser_maxsat.printOPBtoFile(opb_name);
+        opb_written = true;
+      }
     }
 
-    std::cout << "c CNF file " << filename << ".cnf" << std::endl;
+    if (dedup)
+      std::cout << "c Duplicate clauses dropped: "
+                << maxsat_formula.nDuplicateClauses() << std::endl;
+    std::cout << (format == _FORMAT_WBO_ ? "c WCNF file " : "c CNF file ")
+              << cnf_name << std::endl;
     if (proof) {
-      std::cout << "c PBP file " << filename << ".pbp" << std::endl;
+      std::cout << "c PBP file " << pbp_name << std::endl;
+      if (opb_written)
+        std::cout << "c OPB file " << opb_name << std::endl;
     }
 
   } else {
@@ -301,6 +501,22 @@ int main(int argc, char **argv) {
       std::cout << "c | PB - avg coeff size: "
                 << (avg_coeff / maxsat_formula.nPB()) << std::endl;
     }
+
+    const OccurrenceIndex &occurrences = maxsat_formula.getOccurrences();
+    int pure = 0;
+    int64_t max_occurrences = 0;
+    for (int v = 0; v < maxsat_formula.nVars(); v++) {
+      int64_t pos = occurrences.nOccurrences(mkLit(v));
+      int64_t neg = occurrences.nOccurrences(~mkLit(v));
+      if ((pos == 0) != (neg == 0))
+        pure++;
+      max_occurrences = std::max(max_occurrences, pos + neg);
+    }
+
+    std::cout << "c === Occurrence stats ===" << std::endl;
+    std::cout << "c | Variables in one polarity: " << pure << std::endl;
+    std::cout << "c | Max occurrences of a variable: " << max_occurrences
+              << std::endl;
   }
 
   return 0;
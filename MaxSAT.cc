@@ -263,11 +263,10 @@ void MaxSAT::blockModel(Solver *solver) {
 
   printf("v ");
   for (int i = 0; i < model.size(); i++) {
-    indexMap::const_iterator iter = maxsat_formula->getIndexToName().find(i);
-    if (iter != maxsat_formula->getIndexToName().end()) {
+    if (maxsat_formula->getNames().hasName(i)) {
       if (model[i] == l_False)
         printf("-");
-      printf("%s ", iter->second.c_str());
+      printf("%s ", maxsat_formula->getNames().name(i).c_str());
     }
   }
   printf("\n");
@@ -296,11 +295,10 @@ void MaxSAT::printModel() {
 
   if (maxsat_formula->getFormat() == _FORMAT_PB_) {
     for (int i = 0; i < model.size(); i++) {
-      indexMap::const_iterator iter = maxsat_formula->getIndexToName().find(i);
-      if (iter != maxsat_formula->getIndexToName().end()) {
+      if (maxsat_formula->getNames().hasName(i)) {
         if (model[i] == l_False)
           s << "-";
-        s << iter->second.c_str() << " ";
+        s << maxsat_formula->getNames().name(i) << " ";
       }
     }
   } else {
@@ -435,10 +433,12 @@ uint64_t MaxSAT::getUB() {
   for (int i = 0; i < maxsat_formula->nVars() + maxsat_formula->nSoft(); i++)
     newSATVariable(solver);
 
-  for (int i = 0; i < maxsat_formula->nHard(); i++)
-    solver->addClause(maxsat_formula->getHardClause(i).clause);
-
   vec<Lit> clause;
+  for (int64_t i = 0; i < maxsat_formula->nHard(); i++) {
+    maxsat_formula->getHardClause(i).copyTo(clause);
+    solver->addClause(clause);
+  }
+
   for (int i = 0; i < maxsat_formula->nSoft(); i++) {
     clause.clear();
     maxsat_formula->getSoftClause(i).clause.copyTo(clause);
@@ -481,10 +481,12 @@ std::pair<uint64_t, int> MaxSAT::getLB() {
   for (int i = 0; i < maxsat_formula->nVars() + maxsat_formula->nSoft(); i++)
     newSATVariable(solver);
 
-  for (int i = 0; i < maxsat_formula->nHard(); i++)
-    solver->addClause(maxsat_formula->getHardClause(i).clause);
-
   vec<Lit> clause;
+  for (int64_t i = 0; i < maxsat_formula->nHard(); i++) {
+    maxsat_formula->getHardClause(i).copyTo(clause);
+    solver->addClause(clause);
+  }
+
   for (int i = 0; i < maxsat_formula->nSoft(); i++) {
     clause.clear();
     maxsat_formula->getSoftClause(i).clause.copyTo(clause);
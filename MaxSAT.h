@@ -151,7 +151,7 @@ public:
   std::pair<uint64_t, int> getLB();
 
   Soft &getSoftClause(int i) { return maxsat_formula->getSoftClause(i); }
-  Hard &getHardClause(int i) { return maxsat_formula->getHardClause(i); }
+  Hard getHardClause(int64_t i) { return maxsat_formula->getHardClause(i); }
   Lit getAssumptionLit(int soft) {
     return maxsat_formula->getSoftClause(soft).assumption_var;
   }
@@ -27,7 +27,9 @@
  *
  */
 
+#include <algorithm>
 #include <iostream>
+#include <new>
 
 #include "MaxSATFormula.h"
 
@@ -46,7 +48,7 @@ using namespace openwbo;
 //   for (int i = 0; i < nSoft(); i++)
 //     copymx->addSoftClause(getSoftClause(i).weight, getSoftClause(i).clause);
 
-//   for (int i = 0; i < nHard(); i++)
+//   for (int64_t i = 0; i < nHard(); i++)
 //     copymx->addHardClause(NULL, getHardClause(i).clause);
 
 //   copymx->setProblemType(getProblemType());
@@ -57,14 +59,109 @@ using namespace openwbo;
 //   return copymx;
 // }
 
-// Adds a new hard clause to the hard clause database.
-void MaxSATFormula::addHardClause(Constraint *ctr, vec<Lit> &lits) {
-  ctr->clause_ids.push(n_hard);
-  hard_clauses.push();
-  vec<Lit> copy_lits;
-  lits.copyTo(copy_lits);
-  new (&hard_clauses[hard_clauses.size() - 1]) Hard(copy_lits, 0);
+// Adds a new hard clause to the hard clause database. The literals are
+// appended to the clause arena, so that adding a clause does not allocate
+// memory unless the arena has to grow.
+bool MaxSATFormula::addHardClause(Constraint *ctr, vec<Lit> &lits) {
+  if (dedup_clauses) {
+    lits.copyTo(sorted_clause);
+    std::sort((Lit *)sorted_clause, (Lit *)sorted_clause + lits.size());
+    // keep the set at most half full; clauses that were stored before
+    // deduplication was enabled, e.g. from a snapshot, are inserted first
+    if (n_hashed < n_hard || 2 * (n_hard + 1) > (int64_t)clause_table.size())
+      rehashClauses(4 * (n_hard + 1));
+    uint64_t hash = hashClause(sorted_clause, sorted_clause.size());
+    int64_t slot;
+    if (findClause(sorted_clause, hash, slot)) {
+      n_duplicates++;
+      return false;
+    }
+    clause_table[slot] = n_hard;
+    n_hashed++;
+    hard_lits.insert(hard_lits.end(), (Lit *)sorted_clause,
+                     (Lit *)sorted_clause + sorted_clause.size());
+  } else
+    hard_lits.insert(hard_lits.end(), (Lit *)lits, (Lit *)lits + lits.size());
+  // the clauses of a constraint are consecutive
+  if (ctr->clause_begin == ctr->clause_end)
+    ctr->clause_begin = ctr->clause_end = n_hard;
+  assert(ctr->clause_end == n_hard);
+  ctr->clause_end = n_hard + 1;
+  hard_ends.push_back(hard_lits.size());
   n_hard++;
+  return true;
+}
+
+uint64_t MaxSATFormula::hashClause(const Lit *lits, int size) {
+  uint64_t h = size;
+  for (int i = 0; i < size; i++) {
+    h ^= (uint64_t)toInt(lits[i]);
+    h *= 0x9e3779b97f4a7c15ULL;
+    h ^= h >> 29;
+  }
+  return h;
+}
+
+// Looks up a sorted clause. Returns true if it is stored, and otherwise sets
+// slot to the empty slot where it has to be inserted.
+bool MaxSATFormula::findClause(const vec<Lit> &lits, uint64_t hash,
+                               int64_t &slot) {
+  int64_t mask = clause_table.size() - 1;
+  for (slot = hash & mask; clause_table[slot] != -1;
+       slot = (slot + 1) & mask) {
+    Hard hard = getHardClause(clause_table[slot]);
+    if (hard.size() != lits.size())
+      continue;
+    int i = 0;
+    while (i < lits.size() && hard[i] == lits[i])
+      i++;
+    if (i == lits.size())
+      return true;
+  }
+  return false;
+}
+
+// Rebuilds the hash set with the given power of two number of slots. Stored
+// clauses that are not in the set yet are sorted before they are inserted.
+void MaxSATFormula::rehashClauses(int64_t capacity) {
+  int64_t size = 16;
+  while (size < capacity)
+    size *= 2;
+  clause_table.assign(size, -1);
+  for (int64_t i = 0; i < n_hard; i++) {
+    int64_t begin = i == 0 ? 0 : hard_ends[i - 1];
+    Lit *lits = hard_lits.data() + begin;
+    int n = hard_ends[i] - begin;
+    if (i >= n_hashed)
+      std::sort(lits, lits + n);
+    int64_t mask = size - 1;
+    int64_t slot = hashClause(lits, n) & mask;
+    while (clause_table[slot] != -1)
+      slot = (slot + 1) & mask;
+    clause_table[slot] = i;
+  }
+  n_hashed = n_hard;
+}
+
+// Grows the capacity of v to at least n like vec::capacity, by at least half
+// of the current capacity, so that repeated reserves stay amortized.
+template <class T> static void reserveGrowing(std::vector<T> &v, size_t n) {
+  if (n > v.capacity())
+    v.reserve(std::max(n, v.capacity() + v.capacity() / 2));
+}
+
+// The estimate of the literals assumes ternary clauses, which is the most
+// common size in the encodings.
+void MaxSATFormula::reserveHardClauses(int n) {
+  try {
+    reserveGrowing(hard_ends, n_hard + (size_t)n);
+    reserveGrowing(hard_lits, hard_lits.size() + 3 * (size_t)n);
+  } catch (std::bad_alloc &) {
+    printf("c Error: Not enough memory for %" PRId64 " more hard clauses\n",
+           (int64_t)n_hard + n);
+    printf("s UNKNOWN\n");
+    exit(_ERROR_);
+  }
 }
 
 // Adds a new soft clause to the hard clause database.
@@ -94,6 +191,17 @@ void MaxSATFormula::addSoftClause(uint64_t weight, vec<Lit> &lits,
   n_soft++;
 }
 
+// Reserves space for the variables and constraints announced by the input, so
+// that the containers are not reallocated while parsing. Every constraint adds
+// at least one hard clause once it is encoded. The lists of cardinality and PB
+// constraints only hold pointers and are not reserved, since it is not known
+// how the constraints are split between them.
+void MaxSATFormula::reserve(int vars, int constraints) {
+  _names.reserve(vars);
+  hard_ends.reserve(constraints);
+  hard_lits.reserve(constraints);
+}
+
 int MaxSATFormula::nInitialVars() {
   return n_initial_vars;
 } // Returns the number of variables in the working MaxSAT formula.
@@ -108,7 +216,7 @@ int MaxSATFormula::nSoft() {
   return n_soft;
 } // Returns the number of soft clauses in the working MaxSAT formula.
 
-int MaxSATFormula::nHard() {
+int64_t MaxSATFormula::nHard() {
   return n_hard;
 } // Returns the number of hard clauses in the working MaxSAT formula.
 
@@ -158,22 +266,30 @@ Soft &MaxSATFormula::getSoftClause(int pos) {
   return soft_clauses[pos];
 }
 
-Hard &MaxSATFormula::getHardClause(int pos) {
+Hard MaxSATFormula::getHardClause(int64_t pos) {
   assert(pos < nHard());
-  return hard_clauses[pos];
+  int64_t begin = pos == 0 ? 0 : hard_ends[pos - 1];
+  return Hard(hard_lits.data() + begin, hard_ends[pos] - begin);
 }
 
 void MaxSATFormula::addPBConstraint(PB *p) {
 
   // Add constraint to formula data structure.
   proof_log_id++;
+  bool kept = false;
   if (p->isEmpty()) {
     vec<Lit> empty;
-    clause_ids.push(n_hard);
-    addHardClause(p, empty);
+    if (addHardClause(p, empty))
+      n_input_clauses = n_hard;
   } else {
 
-    if (p->isClause()) {
+    if (p->_big != NULL) {
+      // coefficients that need arbitrary precision are never all 1, so this
+      // is neither a clause nor a cardinality constraint
+      p->_id = proof_log_id;
+      pb_constraints.push(p);
+      kept = true;
+    } else if (p->isClause()) {
       if (p->_sign == _PB_EQUAL_) {
         assert(p->_lits.size() == 1);
         vec<Lit> unit;
@@ -183,65 +299,95 @@ void MaxSATFormula::addPBConstraint(PB *p) {
           unit.push(p->_lits[0]);
         else
           assert(false);
-        clause_ids.push(n_hard);
-        addHardClause(p, unit);
+        if (addHardClause(p, unit))
+          n_input_clauses = n_hard;
       } else if (p->_sign == _PB_GREATER_OR_EQUAL_) {
-        clause_ids.push(n_hard);
-        addHardClause(p, p->_lits);
+        if (addHardClause(p, p->_lits))
+          n_input_clauses = n_hard;
       } else {
-        vec<Lit> neg_lits;
         for (int i = 0; i < p->_lits.size(); i++) {
-          neg_lits.push(~p->_lits[i]);
+          p->_lits[i] = ~p->_lits[i];
         }
-        clause_ids.push(n_hard);
-        addHardClause(p, neg_lits);
+        if (addHardClause(p, p->_lits))
+          n_input_clauses = n_hard;
       }
     } else if (p->isCardinality()) {
-      cardinality_constraints.push(
-          new Card(p->_lits, p->_rhs, p->_sign, proof_log_id));
+      Card *card = new Card();
+      p->_lits.moveTo(card->_lits);
+      card->_rhs = p->_rhs;
+      card->_sign = p->_sign;
+      card->_id = proof_log_id;
+      card->divisor = p->divisor;
+      cardinality_constraints.push(card);
     } else {
       // if (!p->_sign) {
       //   p->changeSign();
       // }
 
       // TODO: test PB constraints
-      pb_constraints.push(
-          new PB(p->_lits, p->_coeffs, p->_rhs, p->_sign, proof_log_id));
+      p->_id = proof_log_id;
+      pb_constraints.push(p);
+      kept = true;
     }
     if (p->_sign == _PB_EQUAL_) {
       proof_log_id++;
     }
   }
+  if (!kept)
+    delete p;
 }
 
-int MaxSATFormula::newVarName(char *varName) {
-  int id = varID(varName);
+int MaxSATFormula::newVarName(const char *varName, int size) {
+  int id = varID(varName, size);
   if (id == var_Undef) {
+    assert(_outputIds.size() == 0);
     id = nVars();
     newVar();
-    std::string s(varName);
-    std::pair<std::string, int> nv(s, id);
-    std::pair<int, std::string> ni(id, s);
-    _nameToIndex.insert(nv);
-    _indexToName.insert(ni);
-    // parse xi variable from PB files
-    // only works if the variables are of that kind
-    assert(s[0] == 'x');
-    std::string varId = s.substr(1, s.size());
-    std::pair<int, int> vi(id, atoi(varId.c_str()));
-    _varMap.insert(vi);
+    _names.add(varName, size, id);
+    // variables named xN keep their index N in the CNF and in the proof
+    int64_t n = _names.index(id);
+    if (n > 0) {
+      std::pair<int, int> vi(id, (int)n);
+      _varMap.insert(vi);
+    }
   }
   return id;
 }
 
-int MaxSATFormula::varID(char *varName) {
-  std::string s(varName);
-
-  nameMap::const_iterator iter = _nameToIndex.find(s);
-  if (iter != _nameToIndex.end()) {
-    return iter->second;
+const vec<int32_t> &MaxSATFormula::getOutputIds() {
+  int first = _outputIds.size();
+  if (first == nVars())
+    return _outputIds;
+  // the ids up to the largest xN index are reserved for the named variables,
+  // even if some of them are not used
+  if (first == 0)
+    for (varMap::const_iterator iter = _varMap.begin(); iter != _varMap.end();
+         ++iter)
+      last_output_id = std::max(last_output_id, iter->second);
+  _outputIds.growTo(nVars());
+  varMap::const_iterator iter = _varMap.lower_bound(first);
+  for (int v = first; v < nVars(); v++) {
+    if (iter != _varMap.end() && iter->first == v) {
+      _outputIds[v] = iter->second;
+      ++iter;
+      continue;
+    }
+    if (last_output_id == INT32_MAX) {
+      printf("c Error: The output ids of the variables do not fit into 32 "
+             "bits\n");
+      printf("s UNKNOWN\n");
+      exit(_ERROR_);
+    }
+    _outputIds[v] = ++last_output_id;
   }
-  return var_Undef;
+  return _outputIds;
+}
+
+const LitNames &MaxSATFormula::getLitNames() {
+  const vec<int32_t> &ids = getOutputIds();
+  for (int v = _litNames.nVars(); v < nVars(); v++)
+    _litNames.add(ids[v]);
+  return _litNames;
 }
 
 void MaxSATFormula::convertPBtoMaxSAT() {
@@ -266,60 +412,97 @@ void MaxSATFormula::convertPBtoMaxSAT() {
     setProblemType(_WEIGHTED_);
 }
 
-void MaxSATFormula::printCNFtoFile(std::string filename) {
-
-  std::ofstream file;
-  std::stringstream ss;
-  file.open(filename + ".cnf");
-  ss << "p cnf " << nVars() << " " << nHard() << "\n";
-
-  for (int i = 0; i < nHard(); i++) {
-    Hard &hard = getHardClause(i);
-    hard.print(ss, getVarMap());
+void MaxSATFormula::openOutput(OutputStream &out, const std::string &filename) {
+  if (!out.open(filename.c_str(), output_format, output_thread)) {
+    printf("c Error: Unable to open output file %s\n", filename.c_str());
+    printf("s UNKNOWN\n");
+    exit(_ERROR_);
   }
-  file << ss.rdbuf();
-  file.close();
 }
 
-void MaxSATFormula::printPBPtoFile(std::string filename) {
-  std::ofstream file;
-  std::stringstream ss;
-  file.open(filename + ".pbp");
-  ss << "pseudo-Boolean proof version 1.2\nf\n";
-
-  for (int i = 0; i < nCardinalityConstraint(); i++) {
-    ss << "# 1\n";
-    Card *card = getCardinalityConstraint(i);
-    for (int j = 0; j < card->proof_expr_id.size(); j++) {
-      PBP *pbp = getProofExpr(card->proof_expr_id[j]);
-      pbp->print(ss, getVarMap());
-    }
-    ss << "# 0\n";
-    for (int j = 0; j < card->clause_ids.size(); j++) {
-      Hard &hard = getHardClause(card->clause_ids[j]);
-      hard.printPBPu(ss, getVarMap());
-    }
-    ss << "w 1\n";
+void MaxSATFormula::closeOutput(OutputStream &out,
+                                const std::string &filename) {
+  if (!out.close()) {
+    printf("c Error: Unable to write output file %s\n", filename.c_str());
+    printf("s UNKNOWN\n");
+    exit(_ERROR_);
   }
-  for (int i = 0; i < nPBConstraint(); i++) {
-    ss << "# 1\n";
-    PB *pb = getPBConstraint(i);
-    for (int j = 0; j < pb->proof_expr_id.size(); j++) {
-      PBP *pbp = getProofExpr(pb->proof_expr_id[j]);
-      pbp->print(ss, getVarMap());
-    }
-    ss << "# 0\n";
-    for (int j = 0; j < pb->clause_ids.size(); j++) {
-      Hard &hard = getHardClause(pb->clause_ids[j]);
-      hard.printPBPu(ss, getVarMap());
-    }
-    ss << "w 1\n";
+}
+
+// The clauses are written straight from the clause arena, without building
+// the file in memory.
+void MaxSATFormula::printCNFtoFile(std::string filename) {
+
+  OutputStream out;
+  openOutput(out, filename);
+  const vec<int32_t> &ids = getOutputIds();
+  out.write("p cnf ");
+  out.writeInt(nOutputVars());
+  out.put(' ');
+  out.writeInt(nHard());
+  out.put('\n');
+
+  for (int64_t i = 0; i < nHard(); i++)
+    getHardClause(i).print(out, ids);
+  closeOutput(out, filename);
+}
+
+// Hard clauses get a weight above the sum of the soft clause weights.
+void MaxSATFormula::printWCNFtoFile(std::string filename) {
+
+  OutputStream out;
+  openOutput(out, filename);
+  uint64_t top = sum_soft_weight < UINT64_MAX ? sum_soft_weight + 1 : UINT64_MAX;
+  const vec<int32_t> &ids = getOutputIds();
+  out.write("p wcnf ");
+  out.writeInt(nOutputVars());
+  out.put(' ');
+  out.writeInt(nHard() + nSoft());
+  out.put(' ');
+  out.writeUInt(top);
+  out.put('\n');
+
+  for (int64_t i = 0; i < nHard(); i++) {
+    out.writeUInt(top);
+    out.put(' ');
+    getHardClause(i).print(out, ids);
   }
-  for (int i = 0; i < clause_ids.size(); i++) {
-    Hard &hard = getHardClause(clause_ids[i]);
-    hard.printPBPu(ss, getVarMap());
+  for (int i = 0; i < nSoft(); i++) {
+    Soft &soft = getSoftClause(i);
+    out.writeUInt(soft.weight);
+    out.put(' ');
+    Hard(soft.clause).print(out, ids);
   }
+  closeOutput(out, filename);
+}
+
+void MaxSATFormula::openPBPFile(std::string filename) {
+  pbp_name = filename;
+  openOutput(pbp_file, pbp_name);
+  pbp_file.write("pseudo-Boolean proof version 1.2\nf\n");
+}
+
+// Segments have to be printed in the order in which the constraints are
+// encoded, since the ids of the proof expressions are consecutive.
+void MaxSATFormula::printPBPSegment(Constraint *ctr) {
+  const LitNames &names = getLitNames();
+  pbp_file.write("# 1\n", 4);
+  for (int64_t pos = ctr->proof_begin; pos < ctr->proof_end;)
+    pos = proof_expr.print(pbp_file, pos, names);
+  pbp_file.write("# 0\n", 4);
+  for (int64_t j = ctr->clause_begin; j < ctr->clause_end; j++)
+    getHardClause(j).printPBPu(pbp_file, names);
+  pbp_file.write("w 1\n", 4);
+}
+
+void MaxSATFormula::closePBPFile() {
+  const LitNames &names = getLitNames();
+  for (int64_t i = 0; i < n_input_clauses; i++)
+    getHardClause(i).printPBPu(pbp_file, names);
+  closeOutput(pbp_file, pbp_name);
+}
 
-  file << ss.rdbuf();
-  file.close();
+void MaxSATFormula::releaseProof(Constraint *ctr) {
+  ctr->proof_begin = ctr->proof_end = 0;
+  proof_expr.clear();
 }
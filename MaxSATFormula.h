@@ -39,10 +39,14 @@
 #include "FormulaPB.h"
 #include "FormulaVeriPB.h"
 #include "MaxTypes.h"
+#include "NameTable.h"
+#include "OccurrenceIndex.h"
+#include "OutputStream.h"
 
 #include <fstream>
 #include <map>
 #include <string>
+#include <vector>
 
 using NSPACE::Lit;
 using NSPACE::lit_Undef;
@@ -51,8 +55,6 @@ using NSPACE::vec;
 
 namespace openwbo {
 
-typedef std::map<std::string, int> nameMap;
-typedef std::map<int, std::string> indexMap;
 typedef std::map<int, int> varMap;
 
 class Soft {
@@ -81,99 +83,53 @@ public:
 };
 
 class Hard {
-  /*! The hard class is used to model the hard clauses in a MaxSAT formula. */
+  /*! The hard class is a handle to a hard clause of a MaxSAT formula. The
+   * literals are not owned by the handle; they live in the clause arena of the
+   * formula, so a handle is only valid until the next clause is added. */
 public:
-  Hard(const vec<Lit> &hard, uint i = 0) {
-    hard.copyTo(clause);
-    id = i;
-  }
+  Hard(const Lit *lits, int size) : _lits(lits), _size(size) {}
+  Hard(vec<Lit> &clause) : _lits(clause), _size(clause.size()) {}
 
-  Hard() {}
-  ~Hard() { clause.clear(); }
-
-  void printPBPu(std::stringstream &ss, varMap &v) {
-    if (clause.size() == 0) {
-      ss << "u >= 1 ;\n";
-    } else {
-      int rhs = 1;
-      ss << "u ";
-      for (int i = 0; i < clause.size(); i++) {
-        if (sign(clause[i])) {
-          ss << "1 ~x";
-          // rhs--;
-        } else
-          ss << "1 x";
-        varMap::const_iterator iter = v.find(var(clause[i]));
-        if (iter != v.end())
-          ss << iter->second << " ";
-        else
-          ss << (var(clause[i]) + 1) << " ";
-      }
-      ss << ">= " << rhs << " ;\n";
-    }
-  }
+  int size() const { return _size; }
+  const Lit &operator[](int i) const { return _lits[i]; }
 
-  std::string printPBPu(varMap &v) {
-    std::stringstream ss;
-    if (clause.size() == 0) {
-      ss << "u >= 1 ;\n";
-    } else {
-      int rhs = 1;
-      ss << "u ";
-      for (int i = 0; i < clause.size(); i++) {
-        if (sign(clause[i])) {
-          ss << "1 ~x";
-          // rhs--;
-        } else
-          ss << "1 x";
-        varMap::const_iterator iter = v.find(var(clause[i]));
-        if (iter != v.end())
-          ss << iter->second << " ";
-        else
-          ss << (var(clause[i]) + 1) << " ";
-      }
-      ss << ">= " << rhs << " ;\n";
-      return ss.str();
-    }
+  void copyTo(vec<Lit> &clause) const {
+    clause.clear();
+    for (int i = 0; i < _size; i++)
+      clause.push(_lits[i]);
   }
 
-  void print(std::stringstream &ss, varMap &v) {
-    if (clause.size() > 0) {
-      for (int i = 0; i < clause.size(); i++) {
-        if (sign(clause[i]))
-          ss << "-";
-        varMap::const_iterator iter = v.find(var(clause[i]));
-        if (iter != v.end())
-          ss << iter->second << " ";
-        else
-          ss << (var(clause[i]) + 1) << " ";
-      }
+  /*! Writes the deletion of the clause from the proof. */
+  void printPBPu(OutputStream &out, const LitNames &names) {
+    out.write("u ", 2);
+    for (int i = 0; i < _size; i++) {
+      out.write("1 ", 2);
+      names.write(out, _lits[i]);
     }
-    ss << "0\n";
+    out.write(">= 1 ;\n", 7);
   }
 
-  std::string print(varMap &v) {
-    std::stringstream ss;
-    assert(clause.size() > 0);
-    for (int i = 0; i < clause.size(); i++) {
-      if (sign(clause[i]))
-        ss << "-";
-      varMap::const_iterator iter = v.find(var(clause[i]));
-      if (iter != v.end())
-        ss << iter->second << " ";
-      else
-        ss << (var(clause[i]) + 1) << " ";
+  /*! Writes the clause in DIMACS format. */
+  void print(OutputStream &out, const vec<int32_t> &ids) {
+    for (int i = 0; i < _size; i++) {
+      if (sign(_lits[i]))
+        out.put('-');
+      out.writeUInt(ids[var(_lits[i])]);
+      out.put(' ');
     }
-    ss << "0";
-    return ss.str();
+    out.write("0\n", 2);
   }
-  vec<Lit> clause; //!< Hard clause
-  uint id;         // !< Clause id
+
+protected:
+  const Lit *_lits; //!< First literal of the clause in the arena
+  int _size;        //!< Number of literals of the clause
 };
 
 class MaxSATFormula {
   /*! This class contains the MaxSAT formula and methods for adding soft and
    * hard clauses. */
+  friend class Snapshot;
+
 public:
   MaxSATFormula()
       : hard_weight(UINT64_MAX), problem_type(_UNWEIGHTED_), n_vars(0),
@@ -182,6 +138,14 @@ public:
     objective_function = NULL;
     format = _FORMAT_MAXSAT_;
     proof_log_id = 0;
+    n_input_clauses = 0;
+    output_format = _OUTPUT_PLAIN_;
+    output_thread = false;
+    dedup_clauses = false;
+    n_hashed = 0;
+    n_duplicates = 0;
+    last_output_id = 0;
+    has_products = false;
   }
 
   ~MaxSATFormula() {
@@ -191,10 +155,6 @@ public:
     }
     soft_clauses.clear();
 
-    for (int i = 0; i < nHard(); i++)
-      hard_clauses[i].clause.clear();
-    hard_clauses.clear();
-
     for (int i = 0; i < cardinality_constraints.size(); i++) {
       delete cardinality_constraints[i];
     }
@@ -202,21 +162,26 @@ public:
     for (int i = 0; i < pb_constraints.size(); i++) {
       delete pb_constraints[i];
     }
-
-    for (int i = 0; i < proof_expr.size(); i++) {
-      delete proof_expr[i];
-    }
-
-    for (int i = 0; i < proof_cls.size(); i++) {
-      delete proof_cls[i];
-    }
   }
 
   // old method - not needed at the moment (needs fixing)
   // MaxSATFormula *copyMaxSATFormula();
 
-  /*! Add a new hard clause. */
-  void addHardClause(Constraint *ctr, vec<Lit> &lits);
+  /*! Add a new hard clause. Returns false if the clause was dropped as a
+   * duplicate, see setDedupClauses. */
+  bool addHardClause(Constraint *ctr, vec<Lit> &lits);
+
+  /*! Drop hard clauses that have the same literals as a stored clause. The
+   * literals of the stored clauses are then kept sorted. A dropped clause is
+   * not added to the provenance of its constraint, so it takes no proof id. */
+  void setDedupClauses(bool dedup) { dedup_clauses = dedup; }
+  int64_t nDuplicateClauses() { return n_duplicates; }
+
+  /*! Reserve space for the number of variables and constraints of the input. */
+  void reserve(int vars, int constraints);
+
+  /*! Reserve space for n more hard clauses. */
+  void reserveHardClauses(int n);
 
   /*! Add a new soft clause. */
   void addSoftClause(uint64_t weight, vec<Lit> &lits);
@@ -226,7 +191,7 @@ public:
 
   int nVars();             // Number of variables.
   int nSoft();             // Number of soft clauses.
-  int nHard();             // Number of hard clauses.
+  int64_t nHard();         // Number of hard clauses.
   void newVar(int v = -1); // New variable. Set to the given value.
 
   Lit newLiteral(bool sign = false); // Make a new literal.
@@ -252,8 +217,8 @@ public:
   /*! Return i-soft clause. */
   Soft &getSoftClause(int pos);
 
-  /*! Return i-hard clause. */
-  Hard &getHardClause(int pos);
+  /*! Return a handle to the i-hard clause. */
+  Hard getHardClause(int64_t pos);
 
   /*! Add a new cardinality constraint. */
   void addCardinalityConstraint(Card *card);
@@ -266,7 +231,9 @@ public:
     return cardinality_constraints[pos];
   }
 
-  /*! Add a new PB constraint. */
+  /*! Add a new PB constraint. The formula takes ownership of pb: it is kept
+   * as the constraint itself or its terms are moved into a Card, so that the
+   * terms built by the parser are never copied. */
   void addPBConstraint(PB *pb);
 
   /*! Return number of PB constraint. */
@@ -275,8 +242,8 @@ public:
   /*! Return i-PB constraint. */
   PB *getPBConstraint(int pos) { return pb_constraints[pos]; }
 
-  int newVarName(char *varName);
-  int varID(char *varName);
+  int newVarName(const char *varName, int size);
+  int varID(const char *varName, int size) { return _names.find(varName, size); }
 
   void addObjFunction(PBObjFunction *of) {
     objective_function = new PBObjFunction(of->_lits, of->_coeffs, of->_const);
@@ -288,6 +255,14 @@ public:
 
   int nPB() { return pb_constraints.size(); }
 
+  /*! Literal occurrence index of the hard clauses and constraints. It is
+   * only refreshed here: the constraints added since the last call, e.g. the
+   * clauses of the encodings, are indexed before it is returned. */
+  const OccurrenceIndex &getOccurrences() {
+    occurrences.update(*this);
+    return occurrences;
+  }
+
   int nConstr() {
     return cardinality_constraints.size() + pb_constraints.size();
   }
@@ -298,11 +273,31 @@ public:
 
   int getFormat() { return format; }
 
-  indexMap &getIndexToName() { return _indexToName; }
+  // Products of an OPB file were linearized, so the proof refers to the
+  // linear PB formula.
+  void setHasProducts() { has_products = true; }
+
+  bool hasProducts() { return has_products; }
+
+  NameTable &getNames() { return _names; }
 
   varMap &getVarMap() { return _varMap; }
 
-  int getIncProofLogId() {
+  /*! Dense map from each variable to its id in the output files. Variables
+   * added since the last call are appended, so that every entry is computed
+   * once. A variable named xN gets id N, and all other variables get the ids
+   * above the largest N in the order in which they were created. All xN names
+   * must be added before the first call. */
+  const vec<int32_t> &getOutputIds();
+
+  /*! Largest id in the output files (call getOutputIds first). */
+  int nOutputVars() { return last_output_id; }
+
+  /*! Text of the literals in the proof. Variables added since the last call
+   * are appended. */
+  const LitNames &getLitNames();
+
+  int64_t getIncProofLogId() {
     proof_log_id++;
     return proof_log_id;
   }
@@ -311,30 +306,72 @@ public:
 
   void decIds() { proof_log_id--; }
 
-  void bumpProofLogId(int offset) { proof_log_id += offset; }
-
-  void printCNFtoFile(std::string filename);
-  void printPBPtoFile(std::string filename);
+  void bumpProofLogId(int64_t offset) { proof_log_id += offset; }
 
-  PBP *getProofExpr(int i) { return proof_expr[i]; }
-  int nProofExpr() { return proof_expr.size(); }
-  void addProofExpr(Constraint *ctr, PBP *pbp) {
-    ctr->proof_expr_id.push(proof_expr.size());
-    proof_expr.push(pbp);
+  /*! Compression of the CNF, proof and OPB files (an OutputFormat),
+   * optionally on a separate thread. */
+  void setOutputCompression(int format, bool threaded) {
+    output_format = format;
+    output_thread = threaded;
   }
 
-  PBP *getProofClauses(int i) { return proof_cls[i]; }
-  int nProofClauses() { return proof_cls.size(); }
+  /*! Open and close an output file with the compression of the output
+   * files. Failures are reported as errors. */
+  void openOutput(OutputStream &out, const std::string &filename);
+  void closeOutput(OutputStream &out, const std::string &filename);
+
+  void printCNFtoFile(std::string filename);
+  void printWCNFtoFile(std::string filename);
+
+  /*! The proof is written while encoding: the segment of each constraint is
+   * printed right after it is encoded, and the proof steps of the constraint
+   * are released afterwards. */
+  void openPBPFile(std::string filename);
+  void printPBPSegment(Constraint *ctr);
+  void closePBPFile();
+
+  /*! Releases the proof steps of the constraint that was encoded last. */
+  void releaseProof(Constraint *ctr);
+
+  ProofBuffer &getProofBuffer() { return proof_expr; }
+
+  /*! Adds a proof step (PBPp, PBPred or PBPu) of the constraint. */
+  template <class T> void addProofExpr(Constraint *ctr, const T &pbp) {
+    int64_t pos = pbp.write(proof_expr);
+    if (ctr->proof_begin == ctr->proof_end)
+      ctr->proof_begin = ctr->proof_end = pos;
+    assert(ctr->proof_end == pos);
+    ctr->proof_end = proof_expr.size();
+  }
 
 protected:
   // MaxSAT database
   //
   vec<Soft> soft_clauses; //<! Stores the soft clauses of the MaxSAT formula.
-  vec<Hard> hard_clauses; //<! Stores the hard clauses of the MaxSAT formula.
-  vec<int> clause_ids;    //<! Ids of the constraints that are clause.
+  std::vector<Lit> hard_lits;     //<! Literals of the hard clauses.
+  std::vector<int64_t> hard_ends; //<! End of each hard clause in 'hard_lits'.
+  int64_t n_input_clauses;        //<! Clauses [0, n) are input constraints.
+
+  // Duplicate hard clauses
+  //
+  bool dedup_clauses;                //<! Drop duplicate hard clauses.
+  std::vector<int64_t> clause_table; //<! Hash set of hard clauses, -1 if empty.
+  int64_t n_hashed;                  //<! Number of clauses in 'clause_table'.
+  int64_t n_duplicates;              //<! Number of dropped hard clauses.
+  vec<Lit> sorted_clause;            //<! Temporary canonical clause.
+
+  uint64_t hashClause(const Lit *lits, int size);
+  bool findClause(const vec<Lit> &lits, uint64_t hash, int64_t &slot);
+  void rehashClauses(int64_t capacity);
+
+  OccurrenceIndex occurrences; //<! Refreshed by getOccurrences.
+
+  ProofBuffer proof_expr; //<! Proof steps of the current constraint.
+  OutputStream pbp_file;  //<! Proof file that is written while encoding.
+  int output_format;      //<! Compression of the output files.
+  bool output_thread;     //<! Compress the output on a separate thread.
 
-  vec<PBP *> proof_expr; //<! Stores the proof expressions of the PB conversion
-  vec<PBP *> proof_cls;  //<! Stores the proof CNF clauses
+  std::string pbp_name;   //<! Name of the proof file.
 
   // PB database
   //
@@ -348,23 +385,26 @@ protected:
   int problem_type;     //<! Stores the type of the MaxSAT problem.
   int n_vars;           //<! Number of variables used in the SAT solver.
   int n_soft;           //<! Number of soft clauses.
-  int n_hard;           //<! Number of hard clauses.
+  int64_t n_hard;       //<! Number of hard clauses.
   int n_initial_vars;   //<! Number of variables of the initial MaxSAT formula.
   uint64_t sum_soft_weight; //<! Sum of weights of soft clauses.
   uint64_t max_soft_weight; //<! Maximum weight of soft clauses.
 
   // Utils for PB formulas
   //
-  nameMap _nameToIndex;  //<! Map from variable name to variable id.
-  indexMap _indexToName; //<! Map from variable id to variable name.
-  varMap _varMap;        //<! Map from variable id in CNF to variable id in PB.
+  NameTable _names; //<! Interned variable names.
+  varMap _varMap;   //<! Map from variable id in CNF to variable id in PB.
+  vec<int32_t> _outputIds; //<! Output id of each variable, see getOutputIds.
+  int last_output_id;      //<! Largest id in '_outputIds'.
+  LitNames _litNames;      //<! Proof text of each variable, see getLitNames.
 
   uint id;           // <! Id for the clauses
-  uint proof_log_id; // <! Id used for the constraints in the proof log
+  int64_t proof_log_id; // <! Id used for the constraints in the proof log
 
   // Format
   //
   int format;
+  bool has_products;
 };
 
 } // namespace openwbo
@@ -0,0 +1,167 @@
+/*!
+ * \author Ruben Martins - rubenm@andrew.cmu.edu
+ *
+ * @section LICENSE
+ *
+ * VeritasPBLib, Copyright (c) 2021-2022, Stephan Gocht, Andy Oertel
+ *                                        Ruben Martins, Jakob Nordstrom
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+#include "NameTable.h"
+
+using namespace openwbo;
+
+// growTo takes its fill value by reference, so the constants need storage
+const uint64_t NameTable::_NO_NAME_;
+const uint64_t NameTable::_INDEX_BIT_;
+
+NameTable::NameTable() : _count(0), _arbitrary(0) {}
+
+/*_________________________________________________________________________________________________
+  |
+  |  add : (name : const char *) (size : int) (v : int)  ->  [void]
+  |
+  |  Description:
+  |
+  |    Adds the name of variable 'v'. Names xN go to the dense index as long as
+  |    it stays proportional to the number of names; everything else (and very
+  |    sparse indices) is copied to the string pool and hashed.
+  |
+  |  Pre-conditions:
+  |    * The name is not in the table yet.
+  |
+  |________________________________________________________________________________________________@*/
+void NameTable::add(const char *name, int size, int v) {
+  if (v >= _ref.size())
+    _ref.growTo(v + 1, _NO_NAME_);
+
+  int64_t n = parseIndex(name, size);
+  if (n > 0) {
+    int64_t limit = 2 * (int64_t)_ref.size() + (1 << 20);
+    // n + 1 has to fit the size of the dense index
+    if (n < INT32_MAX && (n < _indexToVar.size() || n <= limit)) {
+      if (n >= _indexToVar.size())
+        _indexToVar.growTo((int)n + 1, var_Undef);
+      _indexToVar[(int)n] = v;
+      _ref[v] = (uint64_t)n | _INDEX_BIT_;
+      return;
+    }
+  } else
+    _arbitrary++;
+
+  if (2 * (_count + 1) > _slots.size())
+    rehash(_slots.size() == 0 ? 1024 : 2 * _slots.size());
+
+  _ref[v] = _pool.size();
+  for (int i = 0; i < size; i++)
+    _pool.push(name[i]);
+  _pool.push('\0');
+
+  uint64_t mask = _slots.size() - 1;
+  uint64_t i = hash(name, size) & mask;
+  while (_slots[i] != var_Undef)
+    i = (i + 1) & mask;
+  _slots[i] = v;
+  _count++;
+}
+
+int NameTable::findHashed(const char *name, int size, uint64_t h) const {
+  uint64_t mask = _slots.size() - 1;
+  for (uint64_t i = h & mask; _slots[i] != var_Undef; i = (i + 1) & mask) {
+    // the length is checked first, so that a shorter pooled name is not
+    // read past its terminator
+    const char *s = &_pool[_ref[_slots[i]]];
+    if (s[0] == name[0] && strnlen(s, size + 1) == (size_t)size &&
+        memcmp(s, name, size) == 0)
+      return _slots[i];
+  }
+  return var_Undef;
+}
+
+void NameTable::rehash(int capacity) {
+  _slots.clear();
+  _slots.growTo(capacity, var_Undef);
+  uint64_t mask = capacity - 1;
+  for (int v = 0; v < _ref.size(); v++) {
+    if (_ref[v] == _NO_NAME_ || (_ref[v] & _INDEX_BIT_))
+      continue;
+    const char *s = &_pool[_ref[v]];
+    uint64_t i = hash(s, strlen(s)) & mask;
+    while (_slots[i] != var_Undef)
+      i = (i + 1) & mask;
+    _slots[i] = v;
+  }
+}
+
+void NameTable::reserve(int n) {
+  _ref.capacity(n);
+  if (_indexToVar.size() <= n)
+    _indexToVar.growTo(n + 1, var_Undef);
+}
+
+std::string NameTable::name(int v) const {
+  assert(hasName(v));
+  if (_ref[v] & _INDEX_BIT_)
+    return "x" + std::to_string(_ref[v] & ~_INDEX_BIT_);
+  return std::string(&_pool[_ref[v]]);
+}
+
+bool NameTable::isValid(int nVars) const {
+  for (int n = 0; n < _indexToVar.size(); n++)
+    if (_indexToVar[n] != var_Undef &&
+        (_indexToVar[n] < 0 || _indexToVar[n] >= nVars))
+      return false;
+
+  // the names in the pool are null terminated
+  if (_pool.size() > 0 && _pool.last() != '\0')
+    return false;
+  if (_ref.size() > nVars)
+    return false;
+  for (int v = 0; v < _ref.size(); v++) {
+    if (_ref[v] == _NO_NAME_)
+      continue;
+    if (_ref[v] & _INDEX_BIT_) {
+      uint64_t n = _ref[v] & ~_INDEX_BIT_;
+      if (n == 0 || n > INT32_MAX)
+        return false;
+    } else if (_ref[v] >= (uint64_t)_pool.size())
+      return false;
+  }
+
+  // the probes start at 'hash & mask' and end at a free slot, and add keeps
+  // the table at most half full
+  if (_slots.size() & (_slots.size() - 1))
+    return false;
+  int used = 0;
+  for (int i = 0; i < _slots.size(); i++) {
+    int v = _slots[i];
+    if (v == var_Undef)
+      continue;
+    if (v < 0 || v >= _ref.size() || _ref[v] == _NO_NAME_ ||
+        (_ref[v] & _INDEX_BIT_))
+      return false;
+    used++;
+  }
+  return used == _count && 2 * (int64_t)_count <= _slots.size() &&
+         _arbitrary >= 0 && _arbitrary <= _count;
+}
@@ -0,0 +1,140 @@
+/*!
+ * \author Ruben Martins - rubenm@andrew.cmu.edu
+ *
+ * @section LICENSE
+ *
+ * VeritasPBLib, Copyright (c) 2021-2022, Stephan Gocht, Andy Oertel
+ *                                        Ruben Martins, Jakob Nordstrom
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef NameTable_h
+#define NameTable_h
+
+#include "core/SolverTypes.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+
+using NSPACE::vec;
+
+namespace openwbo {
+
+/*! Interned table of the variable names of an OPB file.
+ *
+ * Names of the form xN (N > 0, no leading zeros) are mapped through a dense
+ * array indexed by N and are never stored as strings. All other names are
+ * stored null terminated in a single string pool and are found with an open
+ * addressing hash table. Neither case allocates memory per name.
+ */
+class NameTable {
+  friend class Snapshot;
+
+public:
+  NameTable();
+  ~NameTable() {}
+
+  /*! Returns N if the name is xN, otherwise -1. */
+  static int64_t parseIndex(const char *name, int size) {
+    if (size < 2 || size > 11 || name[0] != 'x' || name[1] == '0')
+      return -1;
+    int64_t n = 0;
+    for (int i = 1; i < size; i++) {
+      unsigned digit = name[i] - '0';
+      if (digit > 9)
+        return -1;
+      n = n * 10 + digit;
+    }
+    return n <= INT32_MAX ? n : -1;
+  }
+
+  /*! Variable with the given name or var_Undef. */
+  int find(const char *name, int size) const {
+    int64_t n = parseIndex(name, size);
+    if (n > 0 && n < _indexToVar.size()) {
+      int v = _indexToVar[(int)n];
+      if (v != var_Undef)
+        return v;
+    }
+    if (_count == 0)
+      return var_Undef;
+    return findHashed(name, size, hash(name, size));
+  }
+
+  /*! Adds a name that is not in the table yet for variable v. */
+  void add(const char *name, int size, int v);
+
+  /*! Reserves space for n names. */
+  void reserve(int n);
+
+  /*! Returns N if v is named xN, otherwise -1. */
+  int64_t index(int v) const {
+    if (!hasName(v))
+      return -1;
+    if (_ref[v] & _INDEX_BIT_)
+      return _ref[v] & ~_INDEX_BIT_;
+    // sparse xN names are stored in the pool
+    const char *s = &_pool[_ref[v]];
+    return parseIndex(s, strlen(s));
+  }
+
+  bool hasName(int v) const { return v < _ref.size() && _ref[v] != _NO_NAME_; }
+
+  /*! Name of v (must have one). */
+  std::string name(int v) const;
+
+  /*! Number of names that are not of the form xN. */
+  int nArbitrary() const { return _arbitrary; }
+
+  /*! Checks that a table that was not built by add, i.e. loaded from a
+   * snapshot, only refers to the variables [0, nVars) and to names in the
+   * pool, so that lookups stay in bounds. */
+  bool isValid(int nVars) const;
+
+protected:
+  static const uint64_t _NO_NAME_ = UINT64_MAX;
+  static const uint64_t _INDEX_BIT_ = ((uint64_t)1) << 62;
+
+  static uint64_t hash(const char *name, int size) {
+    // FNV-1a
+    uint64_t h = 14695981039346656037ULL;
+    for (int i = 0; i < size; i++) {
+      h ^= (unsigned char)name[i];
+      h *= 1099511628211ULL;
+    }
+    return h;
+  }
+
+  int findHashed(const char *name, int size, uint64_t h) const;
+  void rehash(int capacity);
+
+  vec<int> _indexToVar; //<! Dense map from N to the variable named xN.
+  vec<uint64_t> _ref; //<! Per variable: N | _INDEX_BIT_ or offset in _pool.
+  vec<char> _pool;    //<! Null terminated names that are not xN.
+  vec<int> _slots;    //<! Open addressing table of variables (var_Undef free).
+  int _count;         //<! Number of names in _pool.
+  int _arbitrary;     //<! Number of names that are not xN.
+};
+
+} // namespace openwbo
+
+#endif
@@ -0,0 +1,122 @@
+/*!
+ * \author Ruben Martins - rubenm@andrew.cmu.edu
+ *
+ * @section LICENSE
+ *
+ * VeritasPBLib, Copyright (c) 2021-2022, Stephan Gocht, Andy Oertel
+ *                                        Ruben Martins, Jakob Nordstrom
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "OccurrenceIndex.h"
+#include "MaxSATFormula.h"
+
+#include <algorithm>
+
+using namespace openwbo;
+
+/*_________________________________________________________________________________________________
+  |
+  |  update : (mx : MaxSATFormula &)  ->  [void]
+  |
+  |  Description:
+  |
+  |    Adds the constraints that were added to 'mx' since the last update to
+  |    the index. The new occurrences of each literal are appended to its
+  |    slice, which is moved when it is full; the old slices stay in place.
+  |
+  |________________________________________________________________________________________________@*/
+void OccurrenceIndex::update(MaxSATFormula &mx) {
+  int lits = 2 * mx.nVars();
+  if (lits == nLits() && _nHard == mx.nHard() && _nCard == mx.nCard() &&
+      _nPB == mx.nPB())
+    return;
+
+  // literals of new variables start with empty slices
+  _start.resize(lits, 0);
+  _size.resize(lits, 0);
+  _capacity.resize(lits, 0);
+  scan(mx);
+  _nHard = mx.nHard();
+  _nCard = mx.nCard();
+  _nPB = mx.nPB();
+}
+
+// Moves the slice of l to the end of the array with twice its capacity. The
+// old slice becomes a hole, and the array is compacted first if the holes
+// outweigh the occurrences.
+void OccurrenceIndex::grow(int l) {
+  if ((int64_t)_occs.size() > 3 * _nOccs + 4 * (int64_t)nLits())
+    compact();
+  if (_size[l] < _capacity[l])
+    return;
+  int64_t start = _occs.size();
+  int64_t capacity = std::max((int64_t)4, 2 * _capacity[l]);
+  _occs.resize(start + capacity);
+  std::copy(_occs.begin() + _start[l], _occs.begin() + _start[l] + _size[l],
+            _occs.begin() + start);
+  _start[l] = start;
+  _capacity[l] = capacity;
+}
+
+// Copies the slices without the holes, each with room for half of its size,
+// so that a literal has to gain that many occurrences before it moves again.
+void OccurrenceIndex::compact() {
+  int64_t total = 0;
+  for (int l = 0; l < nLits(); l++)
+    total += _size[l] + _size[l] / 2;
+  std::vector<Occurrence> occs(total);
+  int64_t start = 0;
+  for (int l = 0; l < nLits(); l++) {
+    std::copy(_occs.begin() + _start[l], _occs.begin() + _start[l] + _size[l],
+              occs.begin() + start);
+    _start[l] = start;
+    _capacity[l] = _size[l] + _size[l] / 2;
+    start += _capacity[l];
+  }
+  _occs.swap(occs);
+}
+
+// Adds the occurrences of the constraints that are not indexed yet.
+void OccurrenceIndex::scan(MaxSATFormula &mx) {
+  Occurrence occ;
+
+  occ.kind = _OCC_HARD_;
+  for (occ.index = _nHard; occ.index < mx.nHard(); occ.index++) {
+    Hard hard = mx.getHardClause(occ.index);
+    for (int j = 0; j < hard.size(); j++)
+      add(NSPACE::toInt(hard[j]), occ);
+  }
+
+  occ.kind = _OCC_CARD_;
+  for (occ.index = _nCard; occ.index < mx.nCard(); occ.index++) {
+    Card *card = mx.getCardinalityConstraint(occ.index);
+    for (int j = 0; j < card->_lits.size(); j++)
+      add(NSPACE::toInt(card->_lits[j]), occ);
+  }
+
+  occ.kind = _OCC_PB_;
+  for (occ.index = _nPB; occ.index < mx.nPB(); occ.index++) {
+    PB *pb = mx.getPBConstraint(occ.index);
+    for (int j = 0; j < pb->_lits.size(); j++)
+      add(NSPACE::toInt(pb->_lits[j]), occ);
+  }
+}
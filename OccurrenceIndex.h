@@ -0,0 +1,125 @@
+/*!
+ * \author Ruben Martins - rubenm@andrew.cmu.edu
+ *
+ * @section LICENSE
+ *
+ * VeritasPBLib, Copyright (c) 2021-2022, Stephan Gocht, Andy Oertel
+ *                                        Ruben Martins, Jakob Nordstrom
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef OccurrenceIndex_h
+#define OccurrenceIndex_h
+
+#include "core/SolverTypes.h"
+
+#include <stdint.h>
+#include <vector>
+
+using NSPACE::Lit;
+
+namespace openwbo {
+
+class MaxSATFormula;
+
+/*! Literal occurrence index of the hard clauses, cardinality and PB
+ * constraints of a formula.
+ *
+ * Each literal has a slice of a shared array that holds its occurrences, so
+ * that the constraints that contain a literal are found without scanning the
+ * formula. The slices are not contiguous: each one has room to grow, a full
+ * slice is moved to the end of the array with twice its capacity, and the
+ * holes it leaves behind are only removed when they outweigh the occurrences.
+ * The array thus stays within about three times the number of occurrences.
+ *
+ * The index is not told when constraints are added, e.g. when the encoders
+ * append their clauses. It is brought up to date by update, which only visits
+ * the constraints that were added since the previous call, at amortized O(1)
+ * per new occurrence plus O(1) per new literal.
+ */
+class OccurrenceIndex {
+public:
+  enum { _OCC_HARD_ = 0, _OCC_CARD_, _OCC_PB_ };
+
+  struct Occurrence {
+    int kind;      // _OCC_HARD_, _OCC_CARD_ or _OCC_PB_
+    int64_t index; // position among the hard clauses or constraints of its kind
+  };
+
+  /*! Read-only slice of the occurrences of a literal. */
+  class Slice {
+  public:
+    Slice(const Occurrence *occs, int64_t size) : _occs(occs), _size(size) {}
+
+    int64_t size() const { return _size; }
+    const Occurrence &operator[](int64_t i) const { return _occs[i]; }
+    const Occurrence *begin() const { return _occs; }
+    const Occurrence *end() const { return _occs + _size; }
+
+  private:
+    const Occurrence *_occs;
+    int64_t _size;
+  };
+
+  OccurrenceIndex() : _nOccs(0), _nHard(0), _nCard(0), _nPB(0) {}
+
+  /*! Indexes the constraints of mx that were added since the last update. */
+  void update(MaxSATFormula &mx);
+
+  /*! Occurrences of l, in the order in which they were indexed: each update
+   * appends the new hard clauses, then the new Card and PB constraints.
+   * Literals of variables that were created after the last update have none. */
+  Slice occurrences(Lit l) const {
+    int i = NSPACE::toInt(l);
+    if (i >= nLits())
+      return Slice(NULL, 0);
+    return Slice(_occs.data() + _start[i], _size[i]);
+  }
+
+  int64_t nOccurrences(Lit l) const { return occurrences(l).size(); }
+
+  /*! Number of indexed literals, twice the number of indexed variables. */
+  int nLits() const { return (int)_start.size(); }
+
+protected:
+  void scan(MaxSATFormula &mx);
+  void add(int l, const Occurrence &occ) {
+    if (_size[l] == _capacity[l])
+      grow(l);
+    _occs[_start[l] + _size[l]++] = occ;
+    _nOccs++;
+  }
+  void grow(int l);
+  void compact();
+
+  std::vector<int64_t> _start;    //<! Start of the slice of each literal.
+  std::vector<int64_t> _size;     //<! Occurrences of each literal.
+  std::vector<int64_t> _capacity; //<! Room of the slice of each literal.
+  std::vector<Occurrence> _occs;  //<! Slices of the literals and holes.
+  int64_t _nOccs;                 //<! Number of occurrences.
+  int64_t _nHard;                 //<! Number of indexed hard clauses.
+  int _nCard;                     //<! Number of indexed Card constraints.
+  int _nPB;                       //<! Number of indexed PB constraints.
+};
+
+} // namespace openwbo
+
+#endif
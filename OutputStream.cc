@@ -0,0 +1,246 @@
+/*!
+ * \author Ruben Martins - rubenm@andrew.cmu.edu
+ *
+ * @section LICENSE
+ *
+ * VeritasPBLib, Copyright (c) 2021-2022, Stephan Gocht, Andy Oertel
+ *                                        Ruben Martins, Jakob Nordstrom
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "OutputStream.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+
+#ifdef HAS_ZSTD
+#include <zstd.h>
+#endif
+
+using namespace openwbo;
+
+// Size of the buffer for compressed output.
+#define _COMPRESSED_BUFFER_SIZE_ (1 << 18)
+
+struct OutputStream::Compressor {
+  int format;
+  z_stream gz;
+#ifdef HAS_ZSTD
+  ZSTD_CCtx *zstd;
+#endif
+  char out[_COMPRESSED_BUFFER_SIZE_];
+};
+
+const char OutputStream::_DIGITS_[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536"
+    "37383940414243444546474849505152535455565758596061626364656667686970717273"
+    "7475767778798081828384858687888990919293949596979899";
+
+OutputStream::OutputStream()
+    : _fd(-1), _buf(NULL), _pos(0), _failed(false), _compressor(NULL),
+      _spare(NULL), _pending(0), _busy(false), _stop(false) {}
+
+OutputStream::~OutputStream() {
+  if (_fd >= 0)
+    close();
+}
+
+bool OutputStream::supported(int format) {
+  if (format == _OUTPUT_PLAIN_ || format == _OUTPUT_GZIP_)
+    return true;
+#ifdef HAS_ZSTD
+  if (format == _OUTPUT_ZSTD_)
+    return true;
+#endif
+  return false;
+}
+
+bool OutputStream::open(const char *fileName, int format, bool threaded) {
+  if (!supported(format))
+    return false;
+  _fd = ::open(fileName, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (_fd < 0)
+    return false;
+  _buf = (char *)malloc(_OUTPUT_BUFFER_SIZE_);
+  _pos = 0;
+  _failed = false;
+
+  if (format != _OUTPUT_PLAIN_) {
+    _compressor = new Compressor();
+    _compressor->format = format;
+    if (format == _OUTPUT_GZIP_) {
+      // the fastest level, since the output is very repetitive anyway
+      memset(&_compressor->gz, 0, sizeof(z_stream));
+      if (deflateInit2(&_compressor->gz, 1, Z_DEFLATED, 15 + 16, 8,
+                       Z_DEFAULT_STRATEGY) != Z_OK)
+        _failed = true;
+    }
+#ifdef HAS_ZSTD
+    else if ((_compressor->zstd = ZSTD_createCCtx()) == NULL)
+      _failed = true;
+#endif
+  }
+
+  if (threaded) {
+    _spare = (char *)malloc(_OUTPUT_BUFFER_SIZE_);
+    _busy = false;
+    _stop = false;
+    _worker = std::thread(&OutputStream::work, this);
+  }
+  return true;
+}
+
+bool OutputStream::close() {
+  flush();
+  if (_worker.joinable()) {
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _cond.notify_all();
+    _worker.join();
+    free(_spare);
+    _spare = NULL;
+  }
+  if (_compressor != NULL) {
+    emit(NULL, 0, true);
+    if (_compressor->format == _OUTPUT_GZIP_)
+      deflateEnd(&_compressor->gz);
+#ifdef HAS_ZSTD
+    else
+      ZSTD_freeCCtx(_compressor->zstd);
+#endif
+    delete _compressor;
+    _compressor = NULL;
+  }
+  if (::close(_fd) != 0)
+    _failed = true;
+  _fd = -1;
+  free(_buf);
+  _buf = NULL;
+  return !_failed;
+}
+
+void OutputStream::flush() {
+  if (_pos == 0)
+    return;
+  if (!_worker.joinable()) {
+    emit(_buf, _pos, false);
+    _pos = 0;
+    return;
+  }
+  // wait for the thread to finish the previous buffer and hand it this one
+  std::unique_lock<std::mutex> lock(_mutex);
+  while (_busy)
+    _cond.wait(lock);
+  std::swap(_buf, _spare);
+  _pending = _pos;
+  _busy = true;
+  _pos = 0;
+  _cond.notify_all();
+}
+
+void OutputStream::writeLong(const char *s, size_t size) {
+  while (size > 0) {
+    if (_pos == _OUTPUT_BUFFER_SIZE_)
+      flush();
+    size_t n = std::min(size, _OUTPUT_BUFFER_SIZE_ - _pos);
+    memcpy(_buf + _pos, s, n);
+    _pos += n;
+    s += n;
+    size -= n;
+  }
+}
+
+void OutputStream::work() {
+  std::unique_lock<std::mutex> lock(_mutex);
+  for (;;) {
+    while (!_busy && !_stop)
+      _cond.wait(lock);
+    if (!_busy)
+      return;
+    lock.unlock();
+    emit(_spare, _pending, false);
+    lock.lock();
+    _busy = false;
+    _cond.notify_all();
+  }
+}
+
+void OutputStream::emit(const char *buf, size_t size, bool last) {
+  Compressor *c = _compressor;
+  if (c == NULL) {
+    writeRaw(buf, size);
+    return;
+  }
+
+  if (c->format == _OUTPUT_GZIP_) {
+    c->gz.next_in = (Bytef *)buf;
+    c->gz.avail_in = size;
+    int ret;
+    do {
+      c->gz.next_out = (Bytef *)c->out;
+      c->gz.avail_out = _COMPRESSED_BUFFER_SIZE_;
+      ret = deflate(&c->gz, last ? Z_FINISH : Z_NO_FLUSH);
+      if (ret == Z_STREAM_ERROR) {
+        _failed = true;
+        return;
+      }
+      writeRaw(c->out, _COMPRESSED_BUFFER_SIZE_ - c->gz.avail_out);
+    } while (last ? ret != Z_STREAM_END : c->gz.avail_out == 0);
+    return;
+  }
+
+#ifdef HAS_ZSTD
+  ZSTD_inBuffer in = {buf, size, 0};
+  for (;;) {
+    ZSTD_outBuffer out = {c->out, _COMPRESSED_BUFFER_SIZE_, 0};
+    size_t rest = ZSTD_compressStream2(c->zstd, &out, &in,
+                                       last ? ZSTD_e_end : ZSTD_e_continue);
+    if (ZSTD_isError(rest)) {
+      _failed = true;
+      return;
+    }
+    writeRaw(c->out, out.pos);
+    if (last ? rest == 0 : in.pos == in.size)
+      break;
+  }
+#endif
+}
+
+void OutputStream::writeRaw(const char *buf, size_t size) {
+  while (size > 0 && !_failed) {
+    ssize_t n = ::write(_fd, buf, size);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0) {
+      _failed = true;
+      break;
+    }
+    buf += n;
+    size -= n;
+  }
+}
@@ -0,0 +1,165 @@
+/*!
+ * \author Ruben Martins - rubenm@andrew.cmu.edu
+ *
+ * @section LICENSE
+ *
+ * VeritasPBLib, Copyright (c) 2021-2022, Stephan Gocht, Andy Oertel
+ *                                        Ruben Martins, Jakob Nordstrom
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef OutputStream_h
+#define OutputStream_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace openwbo {
+
+enum OutputFormat { _OUTPUT_PLAIN_, _OUTPUT_GZIP_, _OUTPUT_ZSTD_ };
+
+/*! Buffered writer to a file. The output is collected in a fixed-size buffer
+ * that is flushed with write(2) whenever it fills up, so that a file is never
+ * held in memory as a whole. Integers are converted with a table of two-digit
+ * pairs instead of going through iostreams.
+ *
+ * The output can be compressed with gzip or zstd while it is written. With a
+ * compression thread, a full buffer is compressed and written by the thread
+ * while the next one is filled.
+ */
+class OutputStream {
+
+public:
+  OutputStream();
+  ~OutputStream();
+
+  /*! Returns true if the format is supported by this build. */
+  static bool supported(int format);
+
+  /*! Opens (and truncates) the file. Returns false if it cannot be opened. */
+  bool open(const char *fileName, int format = _OUTPUT_PLAIN_,
+            bool threaded = false);
+
+  /*! Flushes the buffer and closes the file. Returns false if any write
+   * failed. */
+  bool close();
+
+  bool isOpen() const { return _fd >= 0; }
+
+  void put(char c) {
+    if (_pos == _OUTPUT_BUFFER_SIZE_)
+      flush();
+    _buf[_pos++] = c;
+  }
+
+  void write(const char *s, size_t size) {
+    if (size > _OUTPUT_BUFFER_SIZE_ - _pos) {
+      writeLong(s, size);
+      return;
+    }
+    memcpy(_buf + _pos, s, size);
+    _pos += size;
+  }
+
+  void write(const char *s) { write(s, strlen(s)); }
+
+  void writeUInt(uint64_t n) {
+    if (_OUTPUT_BUFFER_SIZE_ - _pos < _MAX_DIGITS_)
+      flush();
+    _pos += formatUInt(_buf + _pos, n);
+  }
+
+  void writeInt(int64_t n) {
+    if (n < 0) {
+      put('-');
+      writeUInt(-(uint64_t)n);
+    } else
+      writeUInt(n);
+  }
+
+  /*! Hands the buffered output to the file (or the compression thread). */
+  void flush();
+
+  /*! Writes the decimal digits of n to buf and returns their number. */
+  static int formatUInt(char *buf, uint64_t n) {
+    char tmp[_MAX_DIGITS_];
+    char *p = tmp + _MAX_DIGITS_;
+    while (n >= 100) {
+      const char *d = _DIGITS_ + 2 * (n % 100);
+      n /= 100;
+      *--p = d[1];
+      *--p = d[0];
+    }
+    if (n >= 10) {
+      const char *d = _DIGITS_ + 2 * n;
+      *--p = d[1];
+      *--p = d[0];
+    } else
+      *--p = '0' + n;
+    int size = tmp + _MAX_DIGITS_ - p;
+    memcpy(buf, p, size);
+    return size;
+  }
+
+protected:
+  static const size_t _OUTPUT_BUFFER_SIZE_ = 1 << 20;
+  static const int _MAX_DIGITS_ = 20; // of a 64-bit unsigned integer
+  static const char _DIGITS_[201];    // "00" "01" ... "99"
+
+  struct Compressor;
+
+  void writeLong(const char *s, size_t size);
+
+  // Compresses (unless the output is plain) and writes a block of output.
+  // The last block ends the compressed stream.
+  void emit(const char *buf, size_t size, bool last);
+
+  // Writes bytes to the file.
+  void writeRaw(const char *buf, size_t size);
+
+  // Body of the compression thread.
+  void work();
+
+  int _fd;
+  char *_buf;
+  size_t _pos;
+  bool _failed;
+  Compressor *_compressor; //<! NULL for plain output.
+
+  // Compression thread
+  //
+  std::thread _worker;
+  std::mutex _mutex;
+  std::condition_variable _cond;
+  char *_spare;     //<! Buffer that is handed to the thread.
+  size_t _pending;  //<! Size of the output in '_spare' to be written.
+  bool _busy;       //<! The thread has output to write.
+  bool _stop;       //<! The thread has to exit.
+};
+
+} // namespace openwbo
+
+#endif
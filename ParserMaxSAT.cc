@@ -0,0 +1,269 @@
+/*!
+ * \author Ruben Martins - ruben@sat.inesc-id.pt
+ *
+ * @section LICENSE
+ *
+ * MiniSat,  Copyright (c) 2003-2006, Niklas Een, Niklas Sorensson
+ *           Copyright (c) 2007-2010, Niklas Sorensson
+ * Open-WBO, Copyright (c) 2013-2015, Ruben Martins, Vasco Manquinho, Ines Lynce
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "ParserMaxSAT.h"
+
+using namespace openwbo;
+
+// Variables of DIMACS files are limited so that their index fits into a Lit.
+#define _MAX_DIMACS_VAR_ (1 << 30)
+
+//-------------------------------------------------------------------------
+// Constructor.
+//-------------------------------------------------------------------------
+
+ParserMaxSAT::ParserMaxSAT()
+    : _weighted(true), _top(UINT64_MAX), _ub(-1), _nInputVars(0) {
+  // clauses are added in file order as soon as they are read
+  _threads = 1;
+}
+
+//! Parse an input file line
+
+int ParserMaxSAT::parseLine() {
+  skip_blanks();
+  char c = peek_char();
+
+  if (c == 'c' || c == '\0' || c == '\n') {
+    // Line is a comment or empty
+    readUntilEndOfLine();
+    return 0;
+  } else if (c == 'p') {
+    return parseProblemLine();
+  } else if (c == 'h') {
+    _fileStr++;
+    return parseClause(true);
+  } else {
+    return parseClause(false);
+  }
+}
+
+//! Parse the problem line "p cnf <vars> <clauses>" or
+// "p wcnf <vars> <clauses> [<top>]".
+
+int ParserMaxSAT::parseProblemLine() {
+  _fileStr++;
+  skip_blanks();
+  const char *word;
+  int size;
+  parseWord(&word, &size);
+  if (size == 3 && strncmp(word, "cnf", 3) == 0)
+    _weighted = false;
+  else if (size == 4 && strncmp(word, "wcnf", 4) == 0)
+    _weighted = true;
+  else
+    return _PARSE_ERROR_;
+
+  int64_t vars, clauses;
+  int error;
+  skip_blanks();
+  if ((error = parseNumber(&vars)) != 0)
+    return error;
+  skip_blanks();
+  if ((error = parseNumber(&clauses)) != 0)
+    return error;
+  if (vars < 0 || vars >= _MAX_DIMACS_VAR_ || clauses < 0)
+    return _PARSE_ERROR_;
+  skip_blanks();
+  if (_weighted && peek_char() != '\n' && peek_char() != '\0') {
+    if ((error = parseWeight(&_top)) != 0)
+      return error;
+    maxsat_formula->setHardWeight(_top);
+  }
+  skip_blanks();
+  if (peek_char() != '\n' && peek_char() != '\0')
+    return _PARSE_ERROR_;
+  readUntilEndOfLine();
+
+  maxsat_formula->newVar(vars);
+  maxsat_formula->reserve(0, std::min(clauses, (int64_t)_MAX_RESERVE_));
+  return 0;
+}
+
+//! Parse an unsigned weight that may use all 64 bits.
+
+int ParserMaxSAT::parseWeight(uint64_t *weight) {
+  const char *start = _fileStr;
+  uint64_t conv = 0;
+  while (_fileStr < _fileEnd && (unsigned)(*_fileStr - '0') < 10) {
+    unsigned digit = *_fileStr - '0';
+    if (conv > (UINT64_MAX - digit) / 10)
+      return _PARSE_OVERFLOW_;
+    conv = conv * 10 + digit;
+    _fileStr++;
+  }
+  if (_fileStr == start)
+    return _PARSE_ERROR_;
+  *weight = conv;
+  return 0;
+}
+
+//! Parse a clause that ends with 0 on the same line. Soft clauses are stored
+// until relaxSoftClauses is called, hard clauses are added right away.
+
+int ParserMaxSAT::parseClause(bool hard) {
+  uint64_t weight = 1;
+  int error;
+  if (_weighted && !hard) {
+    if ((error = parseWeight(&weight)) != 0)
+      return error;
+    if (weight == 0)
+      return _PARSE_ERROR_;
+    hard = weight >= _top;
+  }
+
+  _clause.clear();
+  for (;;) {
+    int64_t lit;
+    skip_blanks();
+    if ((error = parseNumber(&lit)) != 0)
+      return error;
+    if (lit == 0)
+      break;
+    int64_t v = lit < 0 ? -lit : lit;
+    if (v >= _MAX_DIMACS_VAR_)
+      return _PARSE_OVERFLOW_;
+    maxsat_formula->newVar(v);
+    _clause.push(mkLit(v - 1, lit < 0));
+  }
+  skip_blanks();
+  if (peek_char() != '\n' && peek_char() != '\0')
+    return _PARSE_ERROR_;
+  readUntilEndOfLine();
+
+  if (hard)
+    addInputClause(_clause);
+  else {
+    maxsat_formula->addSoftClause(weight, _clause);
+    // Updates the maximum weight of soft clauses.
+    maxsat_formula->setMaximumWeight(weight);
+    // Updates the sum of the weights of soft clauses.
+    maxsat_formula->updateSumWeights(weight);
+  }
+  return 0;
+}
+
+//! Add a clause to the formula as the constraint "sum lits >= 1". It is
+// normalized like an OPB constraint, so duplicate literals are merged and
+// tautologies only reserve their proof log id.
+
+void ParserMaxSAT::addInputClause(vec<Lit> &lits) {
+  for (int i = 0; i < lits.size(); i++)
+    _inputLits.push(lits[i]);
+  _inputEnds.push(_inputLits.size());
+  addClause(lits);
+}
+
+//! Relax the soft clauses after all hard clauses were read. The relaxed
+// clauses and the bound get the proof log ids that follow the hard clauses.
+
+void ParserMaxSAT::relaxSoftClauses(int64_t ub) {
+  if (maxsat_formula->getMaximumWeight() <= 1)
+    maxsat_formula->setProblemType(_UNWEIGHTED_);
+  else
+    maxsat_formula->setProblemType(_WEIGHTED_);
+
+  vec<Lit> relax(1);
+  for (int i = 0; i < maxsat_formula->nSoft(); i++) {
+    Soft &soft = maxsat_formula->getSoftClause(i);
+    if (soft.clause.size() == 1) {
+      // the clause is falsified iff its negated literal is true
+      relax[0] = ~soft.clause[0];
+    } else {
+      relax[0] = maxsat_formula->newLiteral();
+      soft.clause.push(relax[0]);
+      addInputClause(soft.clause);
+      soft.clause.pop();
+    }
+    relax.copyTo(soft.relaxation_vars);
+    _relaxLits.push(relax[0]);
+    _relaxWeights.push(soft.weight);
+  }
+  _nInputVars = maxsat_formula->nVars();
+  _ub = ub;
+  addCostBound(_relaxLits, _relaxWeights, ub);
+}
+
+//! Print a literal in OPB syntax.
+
+static void printLiteral(OutputStream &out, Lit l, const vec<int32_t> &ids) {
+  out.write(sign(l) ? "~x" : "x");
+  out.writeInt(ids[var(l)]);
+}
+
+// The formula is written straight from the input clauses, without building
+// the file in memory, with the compression of the other output files.
+void ParserMaxSAT::printOPBtoFile(std::string filename) {
+
+  OutputStream out;
+  maxsat_formula->openOutput(out, filename);
+  const vec<int32_t> &v = maxsat_formula->getOutputIds();
+
+  out.write("* #variable= ");
+  out.writeInt(_nInputVars);
+  out.write(" #constraint= ");
+  out.writeInt(_inputEnds.size() + (_ub >= 0 ? 1 : 0));
+  out.put('\n');
+  if (_relaxLits.size() > 0) {
+    out.write("min:");
+    for (int i = 0; i < _relaxLits.size(); i++) {
+      out.write(" +");
+      out.writeUInt(_relaxWeights[i]);
+      out.put(' ');
+      printLiteral(out, _relaxLits[i], v);
+    }
+    out.write(" ;\n");
+  }
+
+  int begin = 0;
+  for (int i = 0; i < _inputEnds.size(); i++) {
+    for (int j = begin; j < _inputEnds[i]; j++) {
+      out.write("+1 ");
+      printLiteral(out, _inputLits[j], v);
+      out.put(' ');
+    }
+    out.write(">= 1 ;\n");
+    begin = _inputEnds[i];
+  }
+
+  if (_ub >= 0) {
+    for (int i = 0; i < _relaxLits.size(); i++) {
+      out.put('+');
+      out.writeUInt(_relaxWeights[i]);
+      out.put(' ');
+      printLiteral(out, _relaxLits[i], v);
+      out.put(' ');
+    }
+    out.write("<= ");
+    out.writeInt(_ub);
+    out.write(" ;\n");
+  }
+
+  maxsat_formula->closeOutput(out, filename);
+}
@@ -30,112 +30,69 @@
 #ifndef ParserMaxSAT_h
 #define ParserMaxSAT_h
 
-#include <stdio.h>
+#include <string>
 
-#include "MaxSATFormula.h"
-#include "core/SolverTypes.h"
-#include "utils/ParseUtils.h"
-
-#ifdef HAS_EXTRA_STREAMBUFFER
-#include "utils/StreamBuffer.h"
-#endif
-
-using NSPACE::mkLit;
-using NSPACE::StreamBuffer;
+#include "ParserPB.h"
 
 namespace openwbo {
 
 //=================================================================================================
-// DIMACS Parser:
-
-template <class B> static uint64_t parseWeight(B &in) {
-  uint64_t val = 0;
-  while ((*in >= 9 && *in <= 13) || *in == 32)
-    ++in;
-  if (*in < '0' || *in > '9')
-    fprintf(stderr, "PARSE ERROR! Unexpected char: %c\n", *in), exit(3);
-  while (*in >= '0' && *in <= '9')
-    val = val * 10 + (*in - '0'), ++in;
-  return val;
-}
-
-template <class B, class MaxSATFormula>
-static uint64_t readClause(B &in, MaxSATFormula *maxsat_formula,
-                           vec<Lit> &lits) {
-  int parsed_lit, var;
-  int64_t weight = 1;
-  lits.clear();
-  if (maxsat_formula->getProblemType() == _WEIGHTED_)
-    weight = parseWeight(in);
-  assert(weight > 0);
-
-  for (;;) {
-    parsed_lit = parseInt(in);
-    if (parsed_lit == 0)
-      break;
-    var = abs(parsed_lit) - 1;
-    while (var >= maxsat_formula->nVars())
-      maxsat_formula->newVar();
-    lits.push((parsed_lit > 0) ? mkLit(var) : ~mkLit(var));
+// DIMACS CNF and WCNF parser:
+//
+// Reads "p cnf" files (all clauses are soft with weight 1), "p wcnf" files
+// (clauses start with their weight, hard clauses have at least the top weight)
+// and the format without a problem line ("h" starts a hard clause, all other
+// clauses start with their weight). Every clause must be on a single line.
+//
+// The input is read with the memory mapped or streamed buffers of ParserPB.
+
+class ParserMaxSAT : public ParserPB {
+
+public:
+  ParserMaxSAT();
+  virtual ~ParserMaxSAT() {}
+
+  void parseMaxSATFormula(char *fileName, MaxSATFormula *max) {
+    maxsat_formula = max;
+    parse(fileName);
   }
-  return weight;
-}
-
-template <class B, class MaxSATFormula>
-static void parseMaxSAT(B &in, MaxSATFormula *maxsat_formula) {
-  vec<Lit> lits;
-  uint64_t hard_weight = UINT64_MAX;
-  for (;;) {
-    skipWhitespace(in);
-    if (*in == EOF)
-      break;
-    else if (*in == 'p') {
-      if (eagerMatch(in, "p cnf")) {
-        parseInt(in); // Variables
-        parseInt(in); // Clauses
-      } else if (eagerMatch(in, "wcnf")) {
-        maxsat_formula->setProblemType(_WEIGHTED_);
-        parseInt(in); // Variables
-        parseInt(in); // Clauses
-        if (*in != '\r' && *in != '\n') {
-          hard_weight = parseWeight(in);
-          maxsat_formula->setHardWeight(hard_weight);
-        }
-      } else
-        printf("c PARSE ERROR! Unexpected char: %c\n", *in),
-            printf("s UNKNOWN\n"), exit(_ERROR_);
-    } else if (*in == 'c' || *in == 'p')
-      skipLine(in);
-    else {
-      uint64_t weight = readClause(in, maxsat_formula, lits);
-      if (weight < hard_weight ||
-          maxsat_formula->getProblemType() == _UNWEIGHTED_) {
-        assert(weight > 0);
-        // Updates the maximum weight of soft clauses.
-        maxsat_formula->setMaximumWeight(weight);
-        // Updates the sum of the weights of soft clauses.
-        maxsat_formula->updateSumWeights(weight);
-        maxsat_formula->addSoftClause(weight, lits);
-      } else
-        maxsat_formula->addHardClause(lits);
-    }
+
+  // Relaxes every soft clause with a new variable r, or with the negation of
+  // the literal of a unit soft clause, and adds "sum w * r <= ub" if ub >= 0.
+  void relaxSoftClauses(int64_t ub);
+
+  // Writes the PB formula of the input and relaxed clauses and of the bound.
+  // It has the same variables and constraint ids as the formula, so the proof
+  // can be checked against it.
+  void printOPBtoFile(std::string filename);
+
+protected:
+  virtual int parseLine();
+  int parseProblemLine();
+  int parseClause(bool hard);
+  int parseWeight(uint64_t *weight);
+  void addInputClause(vec<Lit> &lits);
+
+  inline void skip_blanks() {
+    while (_fileStr < _fileEnd &&
+           (*_fileStr == ' ' || *_fileStr == '\t' || *_fileStr == '\r'))
+      _fileStr++;
   }
-}
 
-// Inserts problem into solver.
-//
-template <class MaxSATFormula>
-static void parseMaxSATFormula(gzFile input_stream,
-                               MaxSATFormula *maxsat_formula) {
-  StreamBuffer in(input_stream);
-  parseMaxSAT(in, maxsat_formula);
-  if (maxsat_formula->getMaximumWeight() == 1)
-    maxsat_formula->setProblemType(_UNWEIGHTED_);
-  else
-    maxsat_formula->setProblemType(_WEIGHTED_);
-
-  // maxsat_formula->setInitialVars(maxsat_formula->nVars());
-}
+  bool _weighted; // clauses start with their weight
+  uint64_t _top;  // weight of hard clauses
+  vec<Lit> _clause;
+
+  // Hard and relaxed clauses in the order of their constraint ids.
+  vec<Lit> _inputLits;
+  vec<int> _inputEnds;
+
+  // Objective over the relaxation literals and its upper bound (or -1).
+  vec<Lit> _relaxLits;
+  vec<uint64_t> _relaxWeights;
+  int64_t _ub;
+  int _nInputVars;
+};
 
 //=================================================================================================
 } // namespace openwbo
@@ -29,11 +29,15 @@
  */
 
 #include <algorithm>
+#include <ctype.h>
 #include <fstream>
 #include <iostream>
+#include <thread>
 #include <unistd.h>
+#include <vector>
 
 #include "ParserPB.h"
+#include "mtl/Sort.h"
 
 using namespace openwbo;
 
@@ -41,7 +45,10 @@ using namespace openwbo;
 // Constructor/destructor.
 //-------------------------------------------------------------------------
 
-ParserPB::ParserPB() : _highestCoeffSum(0) {}
+ParserPB::ParserPB()
+    : _fileSize(0), _threads(1), _headerRead(false), _chunk(NULL),
+      _highestCoeffSum(0), _wbo(false), _top(-1), _headerVars(0),
+      _nProducts(0), _linear(false), maxsat_formula(NULL) {}
 
 ParserPB::~ParserPB() {}
 
@@ -49,8 +56,14 @@ ParserPB::~ParserPB() {}
 
 int ParserPB::parse(char *fileName) {
   _highestCoeffSum = 0;
+  if (_wbo)
+    openOPBOutput();
 
-  if ((_fd = open(fileName, O_RDONLY)) < 0) {
+  if (fileName == NULL) {
+    // Read from a pipe or a redirected file
+    fileName = (char *)"<stdin>";
+    _fd = STDIN_FILENO;
+  } else if ((_fd = open(fileName, O_RDONLY)) < 0) {
     printf("c Error: Unable to open input stream for file %s\n", fileName);
     printf("s UNKNOWN\n");
     exit(_ERROR_);
@@ -63,45 +76,295 @@ int ParserPB::parse(char *fileName) {
     printf("s UNKNOWN\n");
     exit(_ERROR_);
   }
-  cout << "c File size is " << statbuf.st_size << " bytes." << endl;
+  if (S_ISREG(statbuf.st_mode))
+    cout << "c File size is " << statbuf.st_size << " bytes." << endl;
 
-  if ((_fileStr = (char *)mmap(0, statbuf.st_size, PROT_READ, MAP_SHARED, _fd,
-                               0)) == (caddr_t)-1) {
-    cout << "c Error: Unable to put in memory file " << fileName << endl;
+  unsigned char head[InputStream::_INPUT_HEAD_SIZE_];
+  int headSize;
+  int format = InputStream::detect(_fd, head, &headSize);
+  if (format < 0) {
+    cout << "c Error: Unable to read file " << fileName << endl;
     printf("s UNKNOWN\n");
     exit(_ERROR_);
   }
-  char *startMap = _fileStr;
-
-  // vmm - Check why I need to do this!!!!
-  if (strlen(_fileStr) != (unsigned)statbuf.st_size)
-    _fileStr[statbuf.st_size] = '\0';
-
-  int line = 0;
-  while (peek_char() != '\0') {
-    int error = parseLine();
 
-    if (error != 0) {
-      cout << "c Error: Parse Error in line " << ++line << endl;
+  if (format == _INPUT_PLAIN_ && S_ISREG(statbuf.st_mode))
+    parseMapped(fileName, statbuf.st_size);
+  else {
+    InputStream *in = InputStream::create(format, _fd, head, headSize);
+    if (in == NULL) {
+      cout << "c Error: " << InputStream::formatName(format)
+           << " compressed input is not supported by this build" << endl;
       printf("s UNKNOWN\n");
       exit(_ERROR_);
     }
-    line++;
+    if (format != _INPUT_PLAIN_)
+      cout << "c Reading " << InputStream::formatName(format)
+           << " compressed input" << endl;
+    parseStream(fileName, in);
+    delete in;
   }
+  if (_fd != STDIN_FILENO)
+    close(_fd);
 
-  // Clear memory map of input file.
-  munmap(startMap, statbuf.st_size);
-  close(_fd);
+  if (maxsat_formula->getNames().nArbitrary() > 0)
+    cout << "c Warning: " << maxsat_formula->getNames().nArbitrary()
+         << " variable names are not of the form xN and are numbered by "
+            "their internal index in the output"
+         << endl;
 
   // cout << "c Highest Coefficient sum: " << _highestCoeffSum << endl;
 
   return 0;
 }
 
+//! Parse an uncompressed regular file through a memory map.
+
+void ParserPB::parseMapped(char *fileName, off_t size) {
+  _fileSize = size;
+
+  // mmap does not accept empty mappings
+  char *startMap = NULL;
+  if (_fileSize > 0 &&
+      (startMap = (char *)mmap(0, _fileSize, PROT_READ, MAP_SHARED, _fd, 0)) ==
+          (caddr_t)-1) {
+    cout << "c Error: Unable to put in memory file " << fileName << endl;
+    printf("s UNKNOWN\n");
+    exit(_ERROR_);
+  }
+  _fileStr = startMap;
+  _fileEnd = startMap + _fileSize;
+  if (startMap != NULL)
+    madvise(startMap, _fileSize, MADV_SEQUENTIAL);
+
+  int line = 0;
+  if (_threads > 1)
+    parseParallel(_fileStr, _fileEnd, &line);
+  else
+    parseBuffer(&line);
+
+  // Clear memory map of input file.
+  if (startMap != NULL)
+    munmap(startMap, _fileSize);
+}
+
+//! Parse an input stream (pipe, FIFO or compressed file) in chunks. Every
+// chunk handed to the tokenizer ends at a line boundary, so no token or
+// constraint is split between two chunks. The incomplete last line of a chunk
+// is moved to the front of the buffer before it is refilled.
+
+void ParserPB::parseStream(char *fileName, InputStream *in) {
+  size_t capacity = _STREAM_CHUNK_SIZE_;
+  size_t size = 0;
+  char *buffer = (char *)malloc(capacity);
+  bool eof = false;
+  int line = 0;
+  _fileSize = 0;
+
+  while (!eof || size > 0) {
+    while (!eof && size < capacity) {
+      ssize_t n = in->read(buffer + size, capacity - size);
+      if (n < 0) {
+        cout << "c Error: Unable to read input stream for file " << fileName
+             << endl;
+        printf("s UNKNOWN\n");
+        exit(_ERROR_);
+      }
+      if (n == 0)
+        eof = true;
+      size += n;
+      _fileSize += n;
+    }
+
+    char *end = buffer + size;
+    if (!eof) {
+      char *nl = (char *)memrchr(buffer, '\n', size);
+      if (nl == NULL) {
+        // a single line does not fit into the buffer
+        capacity *= 2;
+        buffer = (char *)realloc(buffer, capacity);
+        continue;
+      }
+      end = nl + 1;
+    }
+
+    _fileStr = buffer;
+    _fileEnd = end;
+    parseBuffer(&line);
+
+    size = buffer + size - end;
+    memmove(buffer, end, size);
+  }
+
+  free(buffer);
+}
+
+//! Parse all lines in [_fileStr, _fileEnd).
+
+void ParserPB::parseBuffer(int *line) {
+  while (_fileStr < _fileEnd) {
+    int error = parseLine();
+    (*line)++;
+    if (error != 0)
+      reportError(error, *line);
+  }
+}
+
+//! Print the error of a failed line and terminate.
+
+void ParserPB::reportError(int error, int line) {
+  switch (error) {
+  case _PARSE_OVERFLOW_:
+    cout << "c Error: Integer overflow in line " << line << endl;
+    break;
+  case _PARSE_NO_SIGN_:
+    printf("c Error: end of constraint line without sign\n");
+    break;
+  case _PARSE_INVALID_SIGN_:
+    printf("c Error: invalid constraint sign.\n");
+    break;
+  case _PARSE_INVALID_OBJECTIVE_:
+    cout << "c Error: Invalid objective function " << endl;
+    break;
+  case _PARSE_INVALID_WEIGHT_:
+    cout << "c Error: Invalid weight or top cost in line " << line << endl;
+    break;
+  default:
+    cout << "c Error: Parse Error in line " << line << endl;
+  }
+  printf("s UNKNOWN\n");
+  exit(_ERROR_);
+}
+
+//! Split the input [begin, end) at line boundaries into one chunk per thread.
+// The first chunk is parsed by the calling thread, all others are tokenized
+// concurrently into a ParsedChunk. Names are resolved and constraints are
+// added only when a chunk is merged, in file order, so that variable indices
+// and proof log ids are the same as with the serial parser. The merge takes
+// about half of the parsing work, which bounds the speedup below 2 (see the
+// -parse-threads option in README.md).
+
+void ParserPB::parseParallel(char *begin, char *end, int *line) {
+  int threads = _threads;
+  if ((end - begin) / threads < _MIN_CHUNK_SIZE_)
+    threads = std::max(1, (int)((end - begin) / _MIN_CHUNK_SIZE_));
+
+  std::vector<char *> bounds;
+  bounds.push_back(begin);
+  for (int i = 1; i < threads; i++) {
+    char *b = begin + (end - begin) / threads * i;
+    if (b < bounds.back())
+      b = bounds.back();
+    char *nl = (char *)memchr(b, '\n', end - b);
+    bounds.push_back(nl != NULL ? nl + 1 : end);
+  }
+  bounds.push_back(end);
+
+  std::vector<ParsedChunk *> chunks;
+  std::vector<std::thread> workers;
+  for (int i = 1; i < threads; i++) {
+    chunks.push_back(new ParsedChunk());
+    workers.push_back(std::thread(&ParserPB::tokenizeChunk, bounds[i],
+                                  bounds[i + 1], chunks.back()));
+  }
+
+  _fileStr = bounds[0];
+  _fileEnd = bounds[1];
+  parseBuffer(line);
+
+  for (size_t i = 0; i < workers.size(); i++) {
+    workers[i].join();
+    ParsedChunk *chunk = chunks[i];
+    for (int j = 0; j < chunk->lines.size(); j++) {
+      ParsedLine &l = chunk->lines[j];
+      if (l.kind == _LINE_OBJECTIVE_)
+        addObjective(&chunk->terms[l.begin], l.end - l.begin);
+      else
+        addConstraint(&chunk->terms[l.begin], l.end - l.begin,
+                      (pb_Sign)l.sign, l.rhs, l.bigRhs, chunk->bigs, l.weight);
+    }
+    if (chunk->top >= 0)
+      _top = chunk->top;
+    *line += chunk->nLines;
+    if (chunk->error != 0) {
+      // the remaining workers are still running
+      for (size_t k = i + 1; k < workers.size(); k++)
+        workers[k].join();
+      reportError(chunk->error, *line);
+    }
+    delete chunk;
+  }
+}
+
+//! Tokenize the lines in [begin, end) without touching the formula.
+
+void ParserPB::tokenizeChunk(char *begin, char *end, ParsedChunk *chunk) {
+  ParserPB tokenizer;
+  tokenizer._chunk = chunk;
+  tokenizer._fileStr = begin;
+  tokenizer._fileEnd = end;
+  while (tokenizer._fileStr < tokenizer._fileEnd) {
+    int error = tokenizer.parseLine();
+    chunk->nLines++;
+    if (error != 0) {
+      chunk->error = error;
+      return;
+    }
+  }
+}
+
 //-------------------------------------------------------------------------
 // PROTECTED
 //-------------------------------------------------------------------------
 
+//! Parse the '* #variable= N #constraint= M' header of OPB files and reserve
+// space for the announced variables and constraints. Only the first comment
+// line is checked.
+
+void ParserPB::parseHeader() {
+  _headerRead = true;
+  char *start = _fileStr;
+  char *nl = (char *)memchr(_fileStr, '\n', _fileEnd - _fileStr);
+  char *end = (nl != NULL) ? nl : _fileEnd;
+
+  int64_t vars = 0;
+  int64_t constraints = 0;
+  int64_t products = 0;
+  char *v = (char *)memmem(start, end - start, "#variable=", 10);
+  if (v != NULL) {
+    _fileStr = v + 10;
+    skip_spaces();
+    if (parseNumber(&vars) != 0)
+      vars = 0;
+  }
+  char *c = (char *)memmem(start, end - start, "#constraint=", 12);
+  if (c != NULL) {
+    _fileStr = c + 12;
+    skip_spaces();
+    if (parseNumber(&constraints) != 0)
+      constraints = 0;
+  }
+  char *p = (char *)memmem(start, end - start, "#product=", 9);
+  if (p != NULL) {
+    _fileStr = p + 9;
+    skip_spaces();
+    if (parseNumber(&products) != 0)
+      products = 0;
+  }
+  _fileStr = start;
+
+  // product variables are named after the announced variables
+  if (products > 0) {
+    _headerVars = std::max((int64_t)0, std::min(vars, (int64_t)INT32_MAX));
+    openOPBOutput();
+  }
+
+  vars = std::max((int64_t)0, std::min(vars, (int64_t)_MAX_RESERVE_));
+  constraints =
+      std::max((int64_t)0, std::min(constraints, (int64_t)_MAX_RESERVE_));
+  maxsat_formula->reserve(vars, constraints);
+}
+
 //! Parse an input file line
 
 int ParserPB::parseLine() {
@@ -111,10 +374,16 @@ int ParserPB::parseLine() {
 
   if (c == '*' || c == '\0' || c == 10 || c == '\n') {
     // Line is empty or end of line...
+    if (c == '*' && !_headerRead && _chunk == NULL)
+      parseHeader();
     readUntilEndOfLine();
     return 0;
   } else if (c == 'm') {
     return parseCostFunction();
+  } else if (c == 's') {
+    return parseSoftHeader();
+  } else if (c == '[') {
+    return parseSoftConstraint();
   } else {
     // Line must represent a pseudo-boolean constraint
     return parseConstraint();
@@ -130,23 +399,24 @@ int ParserPB::parseLine() {
 
 int ParserPB::parseCostFunction() {
   // int objective = _PB_MIN_;
-  static char word[MAX_WORD_LENGTH];
+  const char *word;
   int i;
 
-  parseWord(word, &i);
+  parseWord(&word, &i);
 
   // Currently only supports min functions
-  if (strncmp("min:", word, 4) != 0) {
+  if (i < 4 || strncmp("min:", word, 4) != 0) {
     // Not a valid cost function
-    cout << "c Error: Invalid objective function " << endl;
-    cout << "s UNKNOWN" << endl;
-    exit(_ERROR_);
+    readUntilEndOfLine();
+    return _PARSE_INVALID_OBJECTIVE_;
   }
 
   int64_t coeff;
-  char varName[MAX_WORD_LENGTH], c;
+  const char *varName;
+  char c;
   int varNameSize;
-  PBObjFunction *of = new PBObjFunction();
+  vec<ParsedTerm> &terms = _chunk != NULL ? _chunk->terms : _terms;
+  int begin = terms.size();
 
   skip_spaces();
   c = peek_char();
@@ -158,16 +428,16 @@ int ParserPB::parseCostFunction() {
   }
 
   do {
-    int error = parseProduct(&coeff, varName, &varNameSize);
-    if (error == 1) {
+    int error = parseProduct(&coeff, &varName, &varNameSize);
+    if (error != 0) {
       readUntilEndOfLine();
-      delete of;
-      return 1;
+      return error;
+    }
+    terms.push(ParsedTerm(coeff, varName, varNameSize, -1));
+    if ((error = parseFactors(terms)) != 0) {
+      readUntilEndOfLine();
+      return error;
     }
-
-    int varID = getVariableID(varName, varNameSize);
-
-    of->addProduct(mkLit(varID), coeff);
 
     skip_spaces();
     c = peek_char();
@@ -182,9 +452,13 @@ int ParserPB::parseCostFunction() {
     c = peek_char();
   }
 
-  maxsat_formula->addObjFunction(of);
-
-  delete of;
+  if (_chunk != NULL)
+    _chunk->lines.push(
+        ParsedLine(_LINE_OBJECTIVE_, 0, 0, -1, begin, terms.size()));
+  else {
+    addObjective(&terms[begin], terms.size() - begin);
+    terms.clear();
+  }
 
   return 0;
 }
@@ -195,192 +469,890 @@ int ParserPB::parseCostFunction() {
   \param coeff Reference to the coefficient
   \param varName Reference to the string containing the variable name
   \param varNameSize Reference to the number of characters in the variable name
-  \param sign Reference to the literal sign
+  \param big If not NULL, coefficients that do not fit into an int64_t are
+  parsed as big numbers and big is set to their index (otherwise -1)
   \return Returns _PB_PARSER_NO_ERROR_ if the product was correctly parsed.
   Otherwise, returns the respective code error.
 */
 
-int ParserPB::parseProduct(int64_t *coeff, char *varName, int *varNameSize) {
+int ParserPB::parseProduct(int64_t *coeff, const char **varName,
+                           int *varNameSize, int *big) {
 
   skip_spaces();
+  char *start = _fileStr;
   int error = parseNumber(coeff);
-  if (error == 1) return 1;
+  if (big != NULL) {
+    *big = -1;
+    if (error == _PARSE_OVERFLOW_) {
+      _fileStr = start;
+      error = parseBigNumber(big);
+    }
+  }
+  if (error != 0)
+    return error;
   skip_spaces();
   if (peek_char() == '*')
     get_char(); // To allow for '*' between coefficient and variable name
   skip_spaces();
 
   parseWord(varName, varNameSize);
-  if (varName[(*varNameSize) - 1] == ';') {
+  if (*varNameSize > 0 && (*varName)[(*varNameSize) - 1] == ';') {
     // Removes possible ; from variable name
     (*varNameSize)--;
-    varName[*varNameSize] = '\0';
   }
+  if (*varNameSize == 0)
+    return _PARSE_ERROR_;
 
   return 0;
 }
 
+//! Parse the remaining literals of a product whose first literal is the last
+// term. They are added as terms with 0 factors.
+
+int ParserPB::parseFactors(vec<ParsedTerm> &terms) {
+  int head = terms.size() - 1;
+  const char *end = terms[head].name + terms[head].size;
+  if (end < _fileEnd && *end == ';')
+    return 0; // the name of the last literal ended with ';'
+  for (;;) {
+    skip_spaces();
+    char c = peek_char();
+    if (c != '~' && c != '_' && !isalpha((unsigned char)c))
+      return 0;
+    const char *name;
+    int size;
+    parseWord(&name, &size);
+    bool last = name[size - 1] == ';';
+    if (last)
+      size--;
+    if (size == 0)
+      return _PARSE_ERROR_;
+    terms.push(ParsedTerm(0, name, size, -1, 0));
+    terms[head].factors++;
+    if (last)
+      return 0;
+  }
+}
+
 //! Parse a line corresponding to a pseudo-Boolean constraint
 /*!
   \return Returns _PB_PARSER_NO_ERROR_ if the constraint was correctly parsed.
   Otherwise, returns the respective code error.
 */
 
-int ParserPB::parseConstraint() {
+int ParserPB::parseConstraint(int64_t weight) {
   int64_t coeff;
-  char varName[MAX_WORD_LENGTH], c;
+  const char *varName;
+  char c;
   int varNameSize;
-  PB *p = new PB();
+  int big;
+  vec<ParsedTerm> &terms = _chunk != NULL ? _chunk->terms : _terms;
+  int begin = terms.size();
 
   // Read all products
   do {
-    int error = parseProduct(&coeff, varName, &varNameSize);
-    if (error == 1) {
+    int error = parseProduct(&coeff, &varName, &varNameSize, &big);
+    if (error != 0) {
       readUntilEndOfLine();
-      delete p;
-      return 1;
+      return error;
+    }
+    terms.push(ParsedTerm(coeff, varName, varNameSize, big));
+    if ((error = parseFactors(terms)) != 0) {
+      readUntilEndOfLine();
+      return error;
     }
-    int varID = getVariableID(varName, varNameSize);
-
-    p->addProduct(mkLit(varID), coeff);
 
     skip_spaces();
     c = peek_char();
 
     if (c == '\0' || c == 10 || c == 13 || c == '\n') {
       // At the end of the line and no sign was found!!!
-      printf("c Error: end of constraint line without sign\n");
-      printf("s UNKNOWN\n");
-      exit(_ERROR_);
+      readUntilEndOfLine();
+      return _PARSE_NO_SIGN_;
     }
   } while (c != '<' && c != '>' && c != '=');
 
-  // printf("p sign %d\n",p->_sign);
-
   // Read constraint sign
   pb_Sign ctrSign = _PB_GREATER_OR_EQUAL_;
-  p->_sign = _PB_GREATER_OR_EQUAL_;
-  if (c == '=') {
+  if (c == '=')
     ctrSign = _PB_EQUAL_;
-    p->_sign = _PB_EQUAL_;
-  } else if (c == '<') {
+  else if (c == '<')
     ctrSign = _PB_LESS_OR_EQUAL_;
-    p->_sign = _PB_LESS_OR_EQUAL_;
-  }
 
   get_char();
   c = peek_char();
 
   if (ctrSign != _PB_EQUAL_ && c != '=') {
-    printf("c Error: invalid constraint sign.\n");
-    printf("s UNKNOWN\n");
-    exit(_ERROR_);
+    readUntilEndOfLine();
+    return _PARSE_INVALID_SIGN_;
   } else if (ctrSign != _PB_EQUAL_)
     get_char();
 
   skip_spaces();
 
   // Read constraint rhs
-  // int64_t rhs;
+  char *start = _fileStr;
   int error = parseNumber(&coeff);
-  if (error == 1) {
+  big = -1;
+  if (error == _PARSE_OVERFLOW_) {
+    _fileStr = start;
+    error = parseBigNumber(&big);
+  }
+  if (error != 0) {
     readUntilEndOfLine();
-    delete p;
-    return 1;
+    return error;
   }
-  p->addRHS(coeff);
-  // if (ctrSign == _PB_LESS_OR_EQUAL_) {
-  //   p->changeSign();
-  // }
 
   readUntilEndOfLine();
 
-  // check if this constraint is trivially satisfied
-    int64_t total = 0;
-    for (int i = 0; i < p->_coeffs.size(); i++){
-      total += p->_coeffs[i];
-    }
- 
-  if (ctrSign == _PB_GREATER_OR_EQUAL_){
-    
-    if (p->_rhs <= 0){
-      printf("c Warning: trivially satisfied constraint.\n");
-      maxsat_formula->bumpIds();
-    } else if (p->_rhs > total){
-      printf("c Warning: trivially unsatisfied constraint.\n");
-      p->_coeffs.clear();
-      p->_lits.clear();
-      maxsat_formula->addPBConstraint(p);
-    } else if (p->_rhs == total){
-      printf("c Warning: all literals in the constraint must be satisfied.\n");
-      for (int i = 0; i < p->_coeffs.size(); i++){
-        _unit_clauses.push(p->_lits[i]);
-      }
-      maxsat_formula->bumpIds();
+  if (_chunk != NULL)
+    _chunk->lines.push(ParsedLine(_LINE_CONSTRAINT_, ctrSign, coeff, big,
+                                  begin, terms.size(), weight));
+  else {
+    addConstraint(&terms[begin], terms.size() - begin, ctrSign, coeff, big,
+                  _bigs, weight);
+    terms.clear();
+    _bigs.clear();
+  }
+
+  return 0;
+}
+
+//! Parse a soft constraint '[w] terms sign rhs ;' of a WBO file.
 
-    } else {
-     maxsat_formula->addPBConstraint(p);   
+int ParserPB::parseSoftConstraint() {
+  get_char();
+  skip_spaces();
+  int64_t weight;
+  int error = parseNumber(&weight);
+  skip_spaces();
+  if (error == 0 && (weight <= 0 || get_char() != ']'))
+    error = _PARSE_INVALID_WEIGHT_;
+  if (error != 0) {
+    readUntilEndOfLine();
+    return error;
+  }
+  return parseConstraint(weight);
+}
+
+//! Parse the 'soft: top ;' line of a WBO file. The top cost is optional.
+
+int ParserPB::parseSoftHeader() {
+  const char *word;
+  int size;
+  parseWord(&word, &size);
+  if (size < 5 || strncmp("soft:", word, 5) != 0) {
+    readUntilEndOfLine();
+    return _PARSE_ERROR_;
+  }
+  _fileStr -= size - 5; // the top cost may follow without a space
+  skip_spaces();
+  int64_t top;
+  char c = peek_char();
+  if (c >= '0' && c <= '9') {
+    int error = parseNumber(&top);
+    if (error == 0 && top <= 0)
+      error = _PARSE_INVALID_WEIGHT_;
+    if (error != 0) {
+      readUntilEndOfLine();
+      return error;
     }
+    if (_chunk != NULL)
+      _chunk->top = top;
+    else
+      _top = top;
+  }
+  readUntilEndOfLine();
+  return 0;
+}
 
-  } else if (ctrSign == _PB_LESS_OR_EQUAL_){
-    
-    if (p->_rhs < 0){
-      printf("c Warning: trivially unsatisfied constraint.\n");
-      p->_coeffs.clear();
-      p->_lits.clear();
-      maxsat_formula->addPBConstraint(p);
-    } else if (p->_rhs >= total){
-      printf("c Warning: trivially satisfied constraint.\n");
-      maxsat_formula->bumpIds();
-    } else if (p->_rhs == 0){
-      printf("c Warning: all literals in the constraint must be unsatisfied.\n");
-      for (int i = 0; i < p->_coeffs.size(); i++){
-        _unit_clauses.push(~p->_lits[i]);
-      }
-      maxsat_formula->bumpIds();
-    } else {
-     maxsat_formula->addPBConstraint(p);   
+//! Parse an optionally signed integer that does not fit into an int64_t.
+/*!
+  \param big Reference to the index of the number in the big numbers of the
+  current line or chunk
+  \return Returns _PB_PARSER_NO_ERROR_ if the number was correctly parsed.
+  Otherwise, returns the respective code error.
+*/
+
+int ParserPB::parseBigNumber(int *big) {
+  int sign = 1;
+  char c = peek_char();
+  while ((c == '-') || (c == '+')) {
+    if (c == '-')
+      sign = -sign;
+    _fileStr++;
+    skip_spaces();
+    c = peek_char();
+  }
+
+  const char *start = _fileStr;
+  while (_fileStr < _fileEnd && (unsigned)(*_fileStr - '0') < 10)
+    _fileStr++;
+  if (_fileStr == start)
+    return _PARSE_ERROR_;
+
+  std::vector<mpz_class> &bigs = _chunk != NULL ? _chunk->bigs : _bigs;
+  bigs.push_back(mpz_class(std::string(start, _fileStr - start), 10));
+  if (sign < 0)
+    bigs.back() = -bigs.back();
+  *big = bigs.size() - 1;
+  return 0;
+}
+
+//! Add the objective function of a parsed 'min:' line.
+
+void ParserPB::addObjective(const ParsedTerm *terms, int size) {
+  PBObjFunction *of = new PBObjFunction();
+
+  for (int i = 0; i < size; i += terms[i].factors) {
+    Lit l = getTermLiteral(&terms[i]);
+    if (l != lit_Undef)
+      of->addProduct(l, terms[i].coeff);
+  }
+
+  maxsat_formula->addObjFunction(of);
+
+  if (_linear) {
+    for (int i = 0; i < of->_lits.size(); i++) {
+      _linObjLits.push(of->_lits[i]);
+      _linObjCoeffs.push(of->_coeffs[i]);
     }
+  }
+  delete of;
+}
+
+// Outcome of checking a normalized constraint for trivial cases.
+enum {
+  _CTR_KEEP_,
+  _CTR_SATISFIED_,
+  _CTR_UNSATISFIED_,
+  _CTR_ALL_TRUE_,
+  _CTR_ALL_FALSE_
+};
+
+//! Classify a constraint with positive coefficients that sum up to total.
+// Used with int64_t and with mpz_class.
 
+template <class T>
+static int classifyConstraint(pb_Sign ctrSign, const T &rhs, const T &total) {
+  if (ctrSign == _PB_GREATER_OR_EQUAL_) {
+    if (rhs <= 0)
+      return _CTR_SATISFIED_;
+    else if (rhs > total)
+      return _CTR_UNSATISFIED_;
+    else if (rhs == total)
+      return _CTR_ALL_TRUE_;
+  } else if (ctrSign == _PB_LESS_OR_EQUAL_) {
+    if (rhs < 0)
+      return _CTR_UNSATISFIED_;
+    else if (rhs >= total)
+      return _CTR_SATISFIED_;
+    else if (rhs == 0)
+      return _CTR_ALL_FALSE_;
   } else {
     // equality constraints
-    if (p->_rhs < 0 || p->_rhs > total){
-      printf("c Warning: trivially unsatisfied constraint.\n");
-      p->_coeffs.clear();
-      p->_lits.clear();
-      maxsat_formula->addPBConstraint(p);
-      maxsat_formula->bumpIds();
-    } else if (p->_rhs == total){
-      printf("c Warning: all literals in the constraint must be satisfied.\n");
-      for (int i = 0; i < p->_coeffs.size(); i++){
-        _unit_clauses.push(p->_lits[i]);
-      }
-      maxsat_formula->bumpIds();
-      maxsat_formula->bumpIds();
-    } else if (p->_rhs == 0){
-      printf("c Warning: all literals in the constraint must be unsatisfied.\n");
-      for (int i = 0; i < p->_coeffs.size(); i++){
-        _unit_clauses.push(~p->_lits[i]);
+    if (rhs < 0 || rhs > total)
+      return _CTR_UNSATISFIED_;
+    else if (rhs == total)
+      return _CTR_ALL_TRUE_;
+    else if (rhs == 0)
+      return _CTR_ALL_FALSE_;
+  }
+  return _CTR_KEEP_;
+}
+
+static const char *signString(pb_Sign ctrSign) {
+  if (ctrSign == _PB_EQUAL_)
+    return "=";
+  return ctrSign == _PB_LESS_OR_EQUAL_ ? "<=" : ">=";
+}
+
+//! Add a parsed constraint to the formula. Trivial constraints are reported
+// and only reserve their proof log ids. Constraints whose coefficients and
+// rhs may overflow 64 bits while normalizing them are kept with arbitrary
+// precision in PB::_big. Soft constraints (weight > 0) are stored until they
+// are relaxed.
+
+void ParserPB::addConstraint(const ParsedTerm *terms, int size,
+                             pb_Sign ctrSign, int64_t rhs, int bigRhs,
+                             const std::vector<mpz_class> &bigs,
+                             int64_t weight) {
+  if (weight > 0 && !_wbo) {
+    printf("c Error: Soft constraints are only supported in WBO files\n");
+    printf("s UNKNOWN\n");
+    exit(_ERROR_);
+  }
+
+  // the encodings may add 1 to the rhs
+  int64_t bound = 1;
+  bool big = bigRhs >= 0 ||
+             __builtin_add_overflow(bound, rhs < 0 ? -rhs : rhs, &bound);
+  for (int i = 0; i < size && !big; i++) {
+    int64_t c = terms[i].coeff < 0 ? -terms[i].coeff : terms[i].coeff;
+    big = terms[i].big >= 0 || __builtin_add_overflow(bound, c, &bound);
+  }
+
+  // Products are replaced by their variables first, since defining a new one
+  // adds constraints.
+  _termLits.clear();
+  for (int i = 0; i < size; i += terms[i].factors)
+    _termLits.push(getTermLiteral(&terms[i]));
+
+  // Terms of the same variable are merged, which also cancels complementary
+  // literals. The proof checker normalizes the input constraints the same way.
+  if (!big) {
+    for (int i = 0, t = 0; i < size; i += terms[i].factors, t++) {
+      Lit l = _termLits[t];
+      if (l == lit_Undef)
+        continue;
+      if (sign(l)) {
+        mergeProduct(var(l), -terms[i].coeff);
+        rhs -= terms[i].coeff;
+      } else
+        mergeProduct(var(l), terms[i].coeff);
+    }
+    if (weight > 0) {
+      for (int i = 0; i < _constraintVariables.size(); i++) {
+        if (_coefficients[i] != 0) {
+          _softVars.push(_constraintVariables[i]);
+          _softCoeffs.push(_coefficients[i]);
+        }
       }
+      clearTerms();
+      _softEnds.push(_softVars.size());
+      _softRhs.push(rhs);
+      _softSigns.push(ctrSign);
+      _softWeights.push(weight);
+      return;
+    }
+    if (_linear)
+      addLinearConstraint(ctrSign, rhs);
+    addMergedConstraint(ctrSign, rhs);
+    return;
+  }
+
+  if (weight > 0) {
+    printf("c Error: Soft constraints with coefficients beyond 64 bits are "
+           "not supported\n");
+    printf("s UNKNOWN\n");
+    exit(_ERROR_);
+  }
+
+  // the same with arbitrary precision
+  std::vector<mpz_class> merged;
+  mpz_class bigRhsValue = bigRhs >= 0 ? bigs[bigRhs] : mpz_class((long)rhs);
+  for (int i = 0, t = 0; i < size; i += terms[i].factors, t++) {
+    Lit l = _termLits[t];
+    if (l == lit_Undef)
+      continue;
+    mpz_class c = terms[i].big >= 0 ? bigs[terms[i].big]
+                                    : mpz_class((long)terms[i].coeff);
+    if (sign(l)) {
+      c = -c;
+      bigRhsValue += c;
+    }
+    int j = mergeTerm(var(l));
+    if (j == (int)merged.size())
+      merged.push_back(c);
+    else
+      merged[j] += c;
+  }
+
+  if (_linear)
+    addLinearConstraint(ctrSign, bigRhsValue, merged);
+
+  PB *p = new PB();
+  p->_sign = ctrSign;
+  p->_big = new PBBig();
+  p->_big->rhs = bigRhsValue;
+  p->_lits.capacity(_constraintVariables.size());
+  p->_coeffs.capacity(_constraintVariables.size());
+  p->_big->coeffs.reserve(_constraintVariables.size());
+  mpz_class total = 0;
+  for (int i = 0; i < _constraintVariables.size(); i++) {
+    Lit l = mkLit(_constraintVariables[i]);
+    mpz_class &c = merged[i];
+    if (c == 0)
+      continue;
+    if (c < 0) {
+      l = ~l;
+      c = -c;
+      p->_big->rhs += c;
+    }
+    p->_lits.push(l);
+    p->_coeffs.push(PBBig::saturate(c));
+    p->_big->coeffs.push_back(c);
+    total += c;
+  }
+  clearTerms();
+  p->_rhs = PBBig::saturate(p->_big->rhs);
+  addClassifiedConstraint(p, classifyConstraint(ctrSign, p->_big->rhs, total));
+}
+
+//! Add the constraint of the terms merged with mergeProduct. Its coefficients
+// and rhs must fit into 64 bits.
+
+void ParserPB::addMergedConstraint(pb_Sign ctrSign, int64_t rhs) {
+  PB *p = new PB();
+  p->_sign = ctrSign;
+  p->_lits.capacity(_constraintVariables.size());
+  p->_coeffs.capacity(_constraintVariables.size());
+  for (int i = 0; i < _constraintVariables.size(); i++) {
+    if (_coefficients[i] != 0)
+      p->addProduct(mkLit(_constraintVariables[i]), _coefficients[i]);
+  }
+  clearTerms();
+  p->addRHS(rhs);
+
+  int64_t total = p->coeffSum();
+  int trivial = classifyConstraint(ctrSign, p->_rhs, total);
+
+  // Divide by the GCD of the coefficients, rounding the rhs towards the
+  // satisfiable side. The encodings derive the divided constraint in the
+  // proof. Equalities are only divided if the rhs is a multiple of the GCD.
+  int64_t g = trivial == _CTR_KEEP_ ? p->coeffGcd() : 0;
+  if (g > 1 && (ctrSign != _PB_EQUAL_ || p->_rhs % g == 0)) {
+    for (int i = 0; i < p->_coeffs.size(); i++)
+      p->_coeffs[i] /= g;
+    p->updateCoeffStats();
+    if (ctrSign == _PB_LESS_OR_EQUAL_)
+      p->_rhs = p->_rhs / g;
+    else
+      p->_rhs = (p->_rhs + g - 1) / g;
+    p->divisor = g;
+    trivial = classifyConstraint(ctrSign, p->_rhs, total / g);
+  }
+
+  addClassifiedConstraint(p, trivial);
+}
+
+//! Add a normalized constraint to the formula according to its
+// classification. The formula takes ownership of p, otherwise it is deleted.
+
+void ParserPB::addClassifiedConstraint(PB *p, int trivial) {
+  pb_Sign ctrSign = p->_sign;
+  switch (trivial) {
+  case _CTR_SATISFIED_:
+    printf("c Warning: trivially satisfied constraint.\n");
+    maxsat_formula->bumpIds();
+    delete p;
+    break;
+  case _CTR_UNSATISFIED_:
+    printf("c Warning: trivially unsatisfied constraint.\n");
+    p->_coeffs.clear();
+    p->_lits.clear();
+    delete p->_big;
+    p->_big = NULL;
+    maxsat_formula->addPBConstraint(p);
+    if (ctrSign == _PB_EQUAL_)
       maxsat_formula->bumpIds();
+    break;
+  case _CTR_ALL_TRUE_:
+  case _CTR_ALL_FALSE_:
+    if (trivial == _CTR_ALL_TRUE_)
+      printf("c Warning: all literals in the constraint must be satisfied.\n");
+    else
+      printf(
+          "c Warning: all literals in the constraint must be unsatisfied.\n");
+    for (int i = 0; i < p->_lits.size(); i++)
+      _unit_clauses.push(trivial == _CTR_ALL_TRUE_ ? p->_lits[i] : ~p->_lits[i]);
+    maxsat_formula->bumpIds();
+    if (ctrSign == _PB_EQUAL_)
       maxsat_formula->bumpIds();
-    } else {
-     maxsat_formula->addPBConstraint(p);   
+    delete p;
+    break;
+  default:
+    maxsat_formula->addPBConstraint(p);
+  }
+}
+
+//! Position of a variable among the variables of the constraint being added.
+// A new variable gets the next position.
+
+int ParserPB::mergeTerm(int var) {
+  if (_termIndex.size() <= var)
+    _termIndex.growTo(var + 1, -1);
+  if (_termIndex[var] < 0) {
+    _termIndex[var] = _constraintVariables.size();
+    _constraintVariables.push(var);
+  }
+  return _termIndex[var];
+}
+
+//! Add coeff * var to the merged terms of the constraint being added.
+
+void ParserPB::mergeProduct(int var, int64_t coeff) {
+  int j = mergeTerm(var);
+  if (j == _coefficients.size())
+    _coefficients.push(coeff);
+  else
+    _coefficients[j] += coeff;
+}
+
+void ParserPB::clearTerms() {
+  for (int i = 0; i < _constraintVariables.size(); i++)
+    _termIndex[_constraintVariables[i]] = -1;
+  _constraintVariables.clear();
+  _coefficients.clear();
+}
+
+//! Literal of a variable name, which is negated if it starts with '~'.
+
+Lit ParserPB::getLiteral(const char *name, int size) {
+  if (size > 1 && name[0] == '~')
+    return ~mkLit(getVariableID(name + 1, size - 1));
+  return mkLit(getVariableID(name, size));
+}
+
+//! Literal of a linear term or the literal of the variable of a product.
+// Returns lit_Undef if the product contains complementary literals and is
+// always false.
+
+Lit ParserPB::getTermLiteral(const ParsedTerm *term) {
+  if (term->factors == 1)
+    return getLiteral(term->name, term->size);
+
+  _productLits.clear();
+  for (int i = 0; i < term->factors; i++)
+    _productLits.push(getLiteral(term[i].name, term[i].size));
+  NSPACE::sort(_productLits);
+  int n = 0;
+  for (int i = 0; i < _productLits.size(); i++) {
+    if (n > 0 && _productLits[i] == _productLits[n - 1])
+      continue;
+    if (n > 0 && _productLits[i] == ~_productLits[n - 1])
+      return lit_Undef;
+    _productLits[n++] = _productLits[i];
+  }
+  _productLits.shrink(_productLits.size() - n);
+  if (n == 1)
+    return _productLits[0];
+  return mkLit(getProductVariable(_productLits));
+}
+
+//! Variable y of a product of the sorted, distinct literals l1 ... lk. A new
+// y is defined by the clauses ~y v li and y v ~l1 v ... v ~lk, which are
+// added to the formula and to the linear PB formula like input constraints.
+// Every occurrence of the same product uses the same variable.
+
+Var ParserPB::getProductVariable(vec<Lit> &lits) {
+  std::vector<int> key;
+  for (int i = 0; i < lits.size(); i++)
+    key.push_back(toInt(lits[i]));
+  std::map<std::vector<int>, Var>::iterator it = _products.find(key);
+  if (it != _products.end())
+    return it->second;
+
+  if (!_opbName.empty() && (!_linear || _headerVars == 0)) {
+    printf("c Error: Products must be announced by '#variable=' and "
+           "'#product=' in the header to write the linear PB formula for the "
+           "proof\n");
+    printf("s UNKNOWN\n");
+    exit(_ERROR_);
+  }
+
+  // numbered after the variables of the header, so that the variables of the
+  // input keep their indices. The index is not added to the name table, so an
+  // input variable with the same name is rejected instead of taken for y.
+  Var y = maxsat_formula->nVars();
+  maxsat_formula->newVar();
+  maxsat_formula->setHasProducts();
+  _nProducts++;
+  if (_headerVars > 0) {
+    if (_headerVars + _nProducts > INT32_MAX) {
+      printf("c Error: The indices of the product variables do not fit into "
+             "32 bits\n");
+      printf("s UNKNOWN\n");
+      exit(_ERROR_);
     }
+    maxsat_formula->getVarMap()[y] = (int)(_headerVars + _nProducts);
   }
- 
-  delete p;
+  _products[key] = y;
 
-  return 0;
+  vec<Lit> clause(2);
+  clause[0] = ~mkLit(y);
+  for (int i = 0; i < lits.size(); i++) {
+    clause[1] = lits[i];
+    addClause(clause);
+  }
+  clause.clear();
+  clause.push(mkLit(y));
+  for (int i = 0; i < lits.size(); i++)
+    clause.push(~lits[i]);
+  addClause(clause);
+  return y;
+}
+
+//! Add a clause like an input constraint "sum lits >= 1".
+
+void ParserPB::addClause(const vec<Lit> &lits) {
+  int64_t rhs = 1;
+  for (int i = 0; i < lits.size(); i++) {
+    if (sign(lits[i])) {
+      mergeProduct(var(lits[i]), -1);
+      rhs--;
+    } else
+      mergeProduct(var(lits[i]), 1);
+  }
+  if (_linear)
+    addLinearConstraint(_PB_GREATER_OR_EQUAL_, rhs);
+  addMergedConstraint(_PB_GREATER_OR_EQUAL_, rhs);
+}
+
+//! Record the linear PB formula if its file name was given.
+
+void ParserPB::openOPBOutput() {
+  if (!_opbName.empty())
+    _linear = true;
+}
+
+//! Relax the soft constraints after all hard constraints were added. The
+// relaxed constraints and the bound get the proof log ids that follow the
+// hard constraints, in the order of the file.
+
+void ParserPB::relaxSoftConstraints(int64_t ub) {
+  vec<Lit> relax;
+  vec<uint64_t> weights;
+  vec<Lit> unit(1);
+  vec<Lit> relaxVar(1);
+  int begin = 0;
+  for (int i = 0; i < _softEnds.size(); i++) {
+    Lit b = maxsat_formula->newLiteral();
+    pb_Sign ctrSign = (pb_Sign)_softSigns[i];
+    // equalities are relaxed as two inequalities with the same variable
+    if (ctrSign != _PB_LESS_OR_EQUAL_)
+      addRelaxedConstraint(i, begin, b, _PB_GREATER_OR_EQUAL_);
+    if (ctrSign != _PB_GREATER_OR_EQUAL_)
+      addRelaxedConstraint(i, begin, b, _PB_LESS_OR_EQUAL_);
+    begin = _softEnds[i];
+
+    unit[0] = ~b;
+    relaxVar[0] = b;
+    maxsat_formula->addSoftClause(_softWeights[i], unit, relaxVar);
+    // Updates the maximum weight of soft clauses.
+    maxsat_formula->setMaximumWeight(_softWeights[i]);
+    // Updates the sum of the weights of soft clauses.
+    maxsat_formula->updateSumWeights(_softWeights[i]);
+    relax.push(b);
+    weights.push(_softWeights[i]);
+    // the objective of the linear formula is the cost of the soft constraints
+    if (_linear) {
+      _linObjLits.push(b);
+      _linObjCoeffs.push(_softWeights[i]);
+    }
+  }
+  if (maxsat_formula->getMaximumWeight() <= 1)
+    maxsat_formula->setProblemType(_UNWEIGHTED_);
+  else
+    maxsat_formula->setProblemType(_WEIGHTED_);
+
+  // solutions must cost less than the top cost
+  if (_top > 0 && (ub < 0 || _top - 1 < ub))
+    ub = _top - 1;
+  addCostBound(relax, weights, ub);
+}
+
+//! Add soft constraint i, whose terms start at begin, with the relaxation
+// variable b. b gets the coefficient that satisfies the constraint for every
+// assignment of its other literals.
+
+void ParserPB::addRelaxedConstraint(int soft, int begin, Lit b,
+                                    pb_Sign ctrSign) {
+  int64_t rhs = _softRhs[soft];
+  int64_t slack = ctrSign == _PB_GREATER_OR_EQUAL_ ? rhs : -rhs;
+  // the encodings may add 1 to the rhs
+  int64_t bound = 1;
+  bool overflow = __builtin_add_overflow(bound, rhs < 0 ? -rhs : rhs, &bound);
+  for (int i = begin; i < _softEnds[soft]; i++) {
+    int64_t c = _softCoeffs[i];
+    mergeProduct(_softVars[i], c);
+    overflow = overflow || __builtin_add_overflow(bound, c < 0 ? -c : c, &bound);
+    if (ctrSign == _PB_GREATER_OR_EQUAL_ && c < 0)
+      slack -= c;
+    else if (ctrSign == _PB_LESS_OR_EQUAL_ && c > 0)
+      slack += c;
+  }
+  overflow = overflow || (slack > 0 && __builtin_add_overflow(bound, slack,
+                                                              &bound));
+  if (overflow) {
+    printf("c Error: The relaxed soft constraint does not fit into 64 bits\n");
+    printf("s UNKNOWN\n");
+    exit(_ERROR_);
+  }
+  if (slack > 0)
+    mergeProduct(var(b), ctrSign == _PB_GREATER_OR_EQUAL_ ? slack : -slack);
+  if (_linear)
+    addLinearConstraint(ctrSign, rhs);
+  addMergedConstraint(ctrSign, rhs);
+}
+
+//! Add "sum weights[i] * lits[i] <= ub" if ub is not negative.
+
+void ParserPB::addCostBound(const vec<Lit> &lits, const vec<uint64_t> &weights,
+                            int64_t ub) {
+  if (ub < 0)
+    return;
+
+  // the encodings may add 1 to the rhs
+  int64_t rhs = ub;
+  int64_t bound = 1;
+  bool overflow = __builtin_add_overflow(bound, rhs, &bound);
+  for (int i = 0; i < lits.size() && !overflow; i++) {
+    int64_t w = (int64_t)weights[i];
+    overflow = weights[i] > (uint64_t)INT64_MAX ||
+               __builtin_add_overflow(bound, w, &bound);
+    if (overflow)
+      break;
+    if (sign(lits[i])) {
+      mergeProduct(var(lits[i]), -w);
+      rhs -= w;
+    } else
+      mergeProduct(var(lits[i]), w);
+  }
+  if (overflow) {
+    clearTerms();
+    printf("c Error: The sum of the soft clause weights and the upper bound "
+           "does not fit into 64 bits\n");
+    printf("s UNKNOWN\n");
+    exit(_ERROR_);
+  }
+  if (_linear)
+    addLinearConstraint(_PB_LESS_OR_EQUAL_, rhs);
+  addMergedConstraint(_PB_LESS_OR_EQUAL_, rhs);
+}
+
+//! Record the merged terms of the constraint being added in the linear PB
+// formula.
+
+void ParserPB::addLinearConstraint(pb_Sign ctrSign, int64_t rhs) {
+  for (int i = 0; i < _constraintVariables.size(); i++) {
+    if (_coefficients[i] != 0) {
+      _linLits.push(mkLit(_constraintVariables[i]));
+      _linCoeffs.push(_coefficients[i]);
+    }
+  }
+  _linEnds.push(_linLits.size());
+  _linRhs.push(rhs);
+  _linSigns.push(ctrSign);
+  _linBig.push(false);
+}
+
+//! The same with the arbitrary precision coefficients of the merged terms.
+
+void ParserPB::addLinearConstraint(pb_Sign ctrSign, const mpz_class &rhs,
+                                   const std::vector<mpz_class> &coeffs) {
+  for (int i = 0; i < _constraintVariables.size(); i++) {
+    if (coeffs[i] != 0) {
+      _linLits.push(mkLit(_constraintVariables[i]));
+      _linCoeffs.push(_linBigs.size());
+      _linBigs.push_back(coeffs[i]);
+    }
+  }
+  _linEnds.push(_linLits.size());
+  _linRhs.push(_linBigs.size());
+  _linBigs.push_back(rhs);
+  _linSigns.push(ctrSign);
+  _linBig.push(true);
+}
+
+//! Write a term of the linear PB formula followed by a space.
+
+static void writeTerm(OutputStream &out, int64_t coeff, Lit l,
+                      const vec<int32_t> &ids) {
+  if (coeff >= 0)
+    out.put('+');
+  out.writeInt(coeff);
+  out.write(sign(l) ? " ~x" : " x");
+  out.writeInt(ids[var(l)]);
+  out.put(' ');
+}
+
+static void writeTerm(OutputStream &out, const mpz_class &coeff, Lit l,
+                      const vec<int32_t> &ids) {
+  if (coeff >= 0)
+    out.put('+');
+  out.write(coeff.get_str().c_str());
+  out.write(sign(l) ? " ~x" : " x");
+  out.writeInt(ids[var(l)]);
+  out.put(' ');
+}
+
+// The recorded constraints are released once they are written.
+bool ParserPB::closeOPBOutput() {
+  if (!_linear)
+    return false;
+
+  OutputStream out;
+  maxsat_formula->openOutput(out, _opbName);
+  const vec<int32_t> &ids = maxsat_formula->getOutputIds();
+  out.write("* #variable= ");
+  out.writeInt(maxsat_formula->nOutputVars());
+  out.write(" #constraint= ");
+  out.writeInt(_linEnds.size());
+  out.put('\n');
+  if (_linObjLits.size() > 0) {
+    out.write("min: ");
+    for (int i = 0; i < _linObjLits.size(); i++)
+      writeTerm(out, _linObjCoeffs[i], _linObjLits[i], ids);
+    out.write(";\n");
+  }
+
+  int begin = 0;
+  for (int i = 0; i < _linEnds.size(); i++) {
+    for (int j = begin; j < _linEnds[i]; j++) {
+      if (_linBig[i])
+        writeTerm(out, _linBigs[_linCoeffs[j]], _linLits[j], ids);
+      else
+        writeTerm(out, _linCoeffs[j], _linLits[j], ids);
+    }
+    out.write(signString((pb_Sign)_linSigns[i]));
+    out.put(' ');
+    if (_linBig[i])
+      out.write(_linBigs[_linRhs[i]].get_str().c_str());
+    else
+      out.writeInt(_linRhs[i]);
+    out.write(" ;\n");
+    begin = _linEnds[i];
+  }
+  maxsat_formula->closeOutput(out, _opbName);
+
+  _linear = false;
+  _linLits.clear(true);
+  _linCoeffs.clear(true);
+  _linEnds.clear(true);
+  _linRhs.clear(true);
+  _linSigns.clear(true);
+  _linBig.clear(true);
+  std::vector<mpz_class>().swap(_linBigs);
+  _linObjLits.clear(true);
+  _linObjCoeffs.clear(true);
+  return true;
 }
 
 //! Get the variable identifier corresponding to a given name. If the
 // variable does not exist, a new identifier is created.
 
-int ParserPB::getVariableID(char *varName, int varNameSize) {
-  int id = maxsat_formula->varID(varName);
-  if (id == var_Undef)
-    id = maxsat_formula->newVarName(varName);
+int ParserPB::getVariableID(const char *varName, int varNameSize) {
+  int id = maxsat_formula->varID(varName, varNameSize);
+  if (id == var_Undef) {
+    int64_t n = NameTable::parseIndex(varName, varNameSize);
+    // the proof and the formula it refers to name every variable xN
+    if (!_opbName.empty() && n <= 0) {
+      printf("c Error: Variable %.*s is not of the form xN, which is required "
+             "to write the proof\n", varNameSize, varName);
+      printf("s UNKNOWN\n");
+      exit(_ERROR_);
+    }
+    // the indices above the header are those of the product variables
+    if (_headerVars > 0 && n > _headerVars) {
+      printf("c Error: Variable %.*s is above the '#variable=' count of the "
+             "header, after which the product variables are numbered\n",
+             varNameSize, varName);
+      printf("s UNKNOWN\n");
+      exit(_ERROR_);
+    }
+    id = maxsat_formula->newVarName(varName, varNameSize);
+  }
   return id;
 }
 
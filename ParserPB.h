@@ -37,10 +37,14 @@
 #include <sys/types.h>
 
 #include <fstream>
+#include <gmpxx.h>
 #include <iostream>
+#include <map>
 #include <sstream>
 #include <string.h>
+#include <vector>
 
+#include "InputStream.h"
 #include "MaxSATFormula.h"
 #include "MaxTypes.h"
 
@@ -48,7 +52,23 @@ using NSPACE::vec;
 using std::cout;
 using std::endl;
 
-#define MAX_WORD_LENGTH 256
+// Initial size of the buffer for streamed (compressed) input.
+#define _STREAM_CHUNK_SIZE_ (1 << 22)
+
+// Inputs are not split into chunks smaller than this for parallel parsing.
+#define _MIN_CHUNK_SIZE_ (1 << 20)
+
+// At most this many variables and constraints are reserved from the header of
+// an OPB file, so that a wrong header cannot exhaust the memory.
+#define _MAX_RESERVE_ (1 << 22)
+
+// Parser error codes
+#define _PARSE_ERROR_ 1
+#define _PARSE_OVERFLOW_ 2
+#define _PARSE_NO_SIGN_ 3
+#define _PARSE_INVALID_SIGN_ 4
+#define _PARSE_INVALID_OBJECTIVE_ 5
+#define _PARSE_INVALID_WEIGHT_ 6
 
 #ifndef _PB_MIN_
 #define _PB_MIN_ 1
@@ -58,6 +78,48 @@ using std::endl;
 
 namespace openwbo {
 
+// Tokens of a line that was parsed but not yet added to the formula. Names
+// point into the input buffer. Numbers that do not fit into an int64_t are
+// stored in a separate vector of big numbers and referenced by their index.
+// A product of literals is stored as one term per literal: the first holds
+// the coefficient and the number of factors, the others have 0 factors.
+struct ParsedTerm {
+  ParsedTerm() {}
+  ParsedTerm(int64_t c, const char *n, int s, int b, int f = 1)
+      : coeff(c), name(n), size(s), big(b), factors(f) {}
+  int64_t coeff;
+  const char *name;
+  int size;
+  int big; // index of the coefficient in the big numbers or -1
+  int factors;
+};
+
+enum { _LINE_CONSTRAINT_, _LINE_OBJECTIVE_ };
+
+struct ParsedLine {
+  ParsedLine() {}
+  ParsedLine(int k, int s, int64_t r, int br, int b, int e, int64_t w = 0)
+      : kind(k), sign(s), rhs(r), bigRhs(br), begin(b), end(e), weight(w) {}
+  int kind;
+  int sign;
+  int64_t rhs;
+  int bigRhs; // index of the rhs in ParsedChunk::bigs or -1
+  int begin;  // range of the terms in ParsedChunk::terms
+  int end;
+  int64_t weight; // weight of a soft constraint or 0
+};
+
+// Result of tokenizing one chunk of the input on a worker thread.
+struct ParsedChunk {
+  ParsedChunk() : nLines(0), error(0), top(-1) {}
+  vec<ParsedTerm> terms;
+  vec<ParsedLine> lines;
+  std::vector<mpz_class> bigs;
+  int nLines; // number of lines read, including the failed one
+  int error;  // error code of the last line read
+  int64_t top; // top cost of a 'soft:' line in the chunk or -1
+};
+
 /*! Generic parser class in open-wbo. All other parsers inherit from this class.
  */
 class ParserPB {
@@ -74,13 +136,39 @@ public:
   // Interface contract:
   //-------------------------------------------------------------------------
 
+  // Parses the given file or standard input if fileName is NULL.
   virtual int parse(char *fileName);
 
+  // Size in bytes of the last parsed (decompressed) input.
+  off_t getFileSize() { return _fileSize; }
+
+  // Number of threads used to parse uncompressed files.
+  void setThreads(int threads) { _threads = threads; }
+
   void parsePBFormula(char *fileName, MaxSATFormula *max) {
     maxsat_formula = max;
     parse(fileName);
   }
 
+  // Accepts the soft constraints of WBO files.
+  void setWBO() { _wbo = true; }
+
+  // Linear PB formula that is written for WBO files (with the relaxed soft
+  // constraints) and for files with products (with the product variables and
+  // their definitions), so that the proof can be checked against it. Products
+  // must be announced by '#product=' in the header of the file.
+  void setOPBOutput(std::string opbFile) { _opbName = opbFile; }
+
+  // Writes the linear PB formula with its header and objective, compressed
+  // like the other output files, and returns true if it was written. It is
+  // recorded while parsing, since the header needs the final counts.
+  bool closeOPBOutput();
+
+  // Relaxes every soft constraint with a new variable b, adds the soft clause
+  // ~b with the weight of the constraint, and adds "sum w * b <= ub" if ub is
+  // not negative or the file has a top cost (ub is then at most top - 1).
+  void relaxSoftConstraints(int64_t ub);
+
   void addUnitClauses(){
     for (int i = 0; i < _unit_clauses.size(); i++){
       PB *unit = new PB();
@@ -94,67 +182,104 @@ public:
   }
 
 protected:
+  // Input handling.
+  void parseMapped(char *fileName, off_t size);
+  void parseStream(char *fileName, InputStream *in);
+  void parseBuffer(int *line);
+  void parseParallel(char *begin, char *end, int *line);
+  static void tokenizeChunk(char *begin, char *end, ParsedChunk *chunk);
+  void reportError(int error, int line);
+
   // OPB instance parsing.
+  void parseHeader();
   virtual int parseLine();
   virtual int parseCostFunction();
-  virtual int parseConstraint();
-  virtual int parseProduct(int64_t *coeff, char *varName, int *varNameSize);
-  virtual int getVariableID(char *varName, int varNameSize);
-
-  inline char peek_char() { return *_fileStr; }
-  inline char get_char() { return *_fileStr++; }
-  inline void unget_char() { _fileStr--; }
+  virtual int parseConstraint(int64_t weight = 0);
+  int parseSoftConstraint();
+  int parseSoftHeader();
+  virtual int parseProduct(int64_t *coeff, const char **varName,
+                           int *varNameSize, int *big = NULL);
+  int parseBigNumber(int *big);
+  int parseFactors(vec<ParsedTerm> &terms);
+  virtual int getVariableID(const char *varName, int varNameSize);
+
+  // Adding parsed lines to the formula.
+  void addObjective(const ParsedTerm *terms, int size);
+  void openOPBOutput();
+  Lit getLiteral(const char *name, int size);
+  Lit getTermLiteral(const ParsedTerm *term);
+  Var getProductVariable(vec<Lit> &lits);
+  void addClause(const vec<Lit> &lits);
+  int mergeTerm(int var);
+  void mergeProduct(int var, int64_t coeff);
+  void clearTerms();
+  void addConstraint(const ParsedTerm *terms, int size, pb_Sign ctrSign,
+                     int64_t rhs, int bigRhs,
+                     const std::vector<mpz_class> &bigs, int64_t weight);
+  void addMergedConstraint(pb_Sign ctrSign, int64_t rhs);
+  void addClassifiedConstraint(PB *p, int trivial);
+  void addRelaxedConstraint(int soft, int begin, Lit b, pb_Sign ctrSign);
+  void addCostBound(const vec<Lit> &lits, const vec<uint64_t> &weights,
+                    int64_t ub);
+  void addLinearConstraint(pb_Sign ctrSign, int64_t rhs);
+  void addLinearConstraint(pb_Sign ctrSign, const mpz_class &rhs,
+                           const std::vector<mpz_class> &coeffs);
+
+  // The tokenizer works directly on the memory mapped input or on a chunk of
+  // complete lines of a stream [_fileStr, _fileEnd). Reading past the end
+  // returns '\0'.
+  inline char peek_char() { return _fileStr < _fileEnd ? *_fileStr : '\0'; }
+  inline char get_char() { return _fileStr < _fileEnd ? *_fileStr++ : '\0'; }
 
   inline void skip_spaces() {
-    while (get_char() == ' ')
-      ;
-    unget_char();
+    while (_fileStr < _fileEnd && *_fileStr == ' ')
+      _fileStr++;
   }
 
   inline void readUntilEndOfLine() {
-    static char c;
-    while ((c = get_char()) != '\n' && c != '\0')
-      ;
+    // memchr is vectorized by the C library
+    const char *nl =
+        (const char *)memchr(_fileStr, '\n', _fileEnd - _fileStr);
+    _fileStr = (nl != NULL) ? (char *)nl + 1 : _fileEnd;
   }
 
+  // Parses an optionally signed integer. Returns 1 if there are no digits and
+  // 2 if the value does not fit into an int64_t.
   inline int parseNumber(int64_t *coeff) {
-    static char word[MAX_WORD_LENGTH];
-    int i = 0, c = peek_char();
-    int64_t conv;
-
-    *coeff = 1;
+    int sign = 1;
+    char c = peek_char();
     while ((c == '-') || (c == '+')) {
       if (c == '-')
-        *coeff *= -1;
-      get_char();
+        sign = -sign;
+      _fileStr++;
       skip_spaces();
       c = peek_char();
     }
-    while (isdigit(word[i] = get_char())) {
-      i++;
-    }
-    unget_char();
-    word[i] = '\0';
-    if (i <= 0) return 1;
-    //assert(i > 0);
-
-    std::istringstream ss(word);
-    ss >> conv;
 
-    // sscanf(word, "%d", &i);
-    *coeff = (*coeff) * conv;
+    const char *start = _fileStr;
+    uint64_t conv = 0;
+    while (_fileStr < _fileEnd && (unsigned)(*_fileStr - '0') < 10) {
+      unsigned digit = *_fileStr - '0';
+      if (conv > ((uint64_t)INT64_MAX - digit) / 10)
+        return 2;
+      conv = conv * 10 + digit;
+      _fileStr++;
+    }
+    if (_fileStr == start)
+      return 1;
 
+    *coeff = sign * (int64_t)conv;
     return 0;
   }
 
-  inline void parseWord(char *varName, int *varNameSize) {
-    int i = 0;
-    while (isgraph(varName[i] = get_char())) {
-      i++;
-    }
-    unget_char();
-    varName[i] = '\0';
-    *varNameSize = i;
+  // Returns a pointer into the input buffer; the word is not null terminated.
+  inline void parseWord(const char **varName, int *varNameSize) {
+    const char *start = _fileStr;
+    // printable characters except space (isgraph in the C locale)
+    while (_fileStr < _fileEnd && (unsigned char)(*_fileStr - 0x21) < 0x5E)
+      _fileStr++;
+    *varName = start;
+    *varNameSize = _fileStr - start;
   }
 
 protected:
@@ -165,13 +290,59 @@ protected:
   };
 
   char *_fileStr;
+  char *_fileEnd;
   int _fd;
-
+  off_t _fileSize;
+  int _threads;
+  bool _headerRead; // the first comment line was checked for a header
+
+  // Terms and big numbers of the current line (serial parsing) or the chunk
+  // that collects the parsed lines (parallel tokenizing).
+  vec<ParsedTerm> _terms;
+  std::vector<mpz_class> _bigs;
+  ParsedChunk *_chunk;
+
+  // Variables of the constraint being added with their merged coefficients,
+  // and the position of each variable in them (or -1).
   vec<int64_t> _coefficients;
   vec<int> _constraintVariables;
+  vec<int> _termIndex;
 
   int64_t _highestCoeffSum;
 
+  // Soft constraints of WBO files. They are added after all hard constraints,
+  // in the order of the file, once they are relaxed.
+  bool _wbo;
+  int64_t _top; // top cost of the 'soft:' line or -1
+  vec<int> _softVars;
+  vec<int64_t> _softCoeffs;
+  vec<int> _softEnds;
+  vec<int64_t> _softRhs;
+  vec<int> _softSigns;
+  vec<uint64_t> _softWeights;
+  std::string _opbName;
+
+  // Linear PB formula of a WBO file or a file with products. Constraint i has
+  // the terms [_linEnds[i - 1], _linEnds[i]). The coefficients and the rhs of
+  // constraints beyond 64 bits are indices into _linBigs.
+  bool _linear; // the linear PB formula is recorded
+  vec<Lit> _linLits;
+  vec<int64_t> _linCoeffs;
+  vec<int> _linEnds;
+  vec<int64_t> _linRhs;
+  vec<char> _linSigns;
+  vec<bool> _linBig;
+  std::vector<mpz_class> _linBigs;
+  vec<Lit> _linObjLits;
+  vec<int64_t> _linObjCoeffs;
+
+  // Products of literals with the variable that replaces them.
+  std::map<std::vector<int>, Var> _products;
+  int64_t _headerVars; // announced variables, if the header announces products
+  int _nProducts;
+  vec<Lit> _termLits;
+  vec<Lit> _productLits;
+
   MaxSATFormula *maxsat_formula;
 
   vec<Lit> _unit_clauses;
@@ -0,0 +1,397 @@
+/*!
+ * \author Ruben Martins - rubenm@andrew.cmu.edu
+ *
+ * @section LICENSE
+ *
+ * VeritasPBLib, Copyright (c) 2021-2022, Stephan Gocht, Andy Oertel
+ *                                        Ruben Martins, Jakob Nordstrom
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "Snapshot.h"
+
+using namespace openwbo;
+
+static const char _MAGIC_[8] = {'V', 'P', 'B', 'S', 'N', 'A', 'P', '\0'};
+
+static void snapshotError(const char *message, const char *fileName) {
+  printf("c Error: %s %s\n", message, fileName);
+  printf("s UNKNOWN\n");
+  exit(_ERROR_);
+}
+
+namespace {
+
+// Writes the arrays of a snapshot, each padded to a multiple of 8 bytes.
+struct SnapshotWriter {
+  FILE *file;
+  const char *fileName;
+
+  void write(const void *data, size_t size) {
+    static const char zeros[8] = {0};
+    if (size > 0 && fwrite(data, 1, size, file) != size)
+      snapshotError("Unable to write snapshot file", fileName);
+    if (size % 8 != 0 && fwrite(zeros, 1, 8 - size % 8, file) != 8 - size % 8)
+      snapshotError("Unable to write snapshot file", fileName);
+  }
+
+  template <class T> void write(vec<T> &v) {
+    write((T *)v, v.size() * sizeof(T));
+  }
+
+  template <class T> void write(const std::vector<T> &v) {
+    write(v.data(), v.size() * sizeof(T));
+  }
+};
+
+// Returns the arrays of a memory mapped snapshot, which are only valid while
+// the file is mapped.
+struct SnapshotReader {
+  const char *pos;
+  const char *end;
+  const char *fileName;
+
+  template <class T> const T *read(int64_t n) {
+    if (n < 0 || (uint64_t)n > (uint64_t)(end - pos) / sizeof(T))
+      snapshotError("Truncated snapshot file", fileName);
+    const T *data = (const T *)pos;
+    size_t size = n * sizeof(T);
+    pos += size + (size % 8 != 0 ? 8 - size % 8 : 0);
+    if (pos > end)
+      pos = end;
+    return data;
+  }
+
+  template <class T> void read(vec<T> &v, int64_t n) {
+    if (n > INT_MAX)
+      snapshotError("Corrupted snapshot file", fileName);
+    const T *data = read<T>(n);
+    v.clear();
+    v.growTo(n);
+    if (n > 0)
+      memcpy((T *)v, data, n * sizeof(T));
+  }
+};
+
+// Checks that the literals are of the variables of the snapshot.
+void checkLits(const Lit *lits, int64_t n, int nVars, const char *fileName) {
+  for (int64_t i = 0; i < n; i++)
+    if (var(lits[i]) < 0 || var(lits[i]) >= nVars)
+      snapshotError("Corrupted snapshot file", fileName);
+}
+
+} // namespace
+
+//! Write the formula to a snapshot file.
+
+void Snapshot::save(MaxSATFormula *mx, const char *fileName) {
+  Header h;
+  memset(&h, 0, sizeof(Header));
+  memcpy(h.magic, _MAGIC_, sizeof(_MAGIC_));
+  h.version = _VERSION_;
+  h.byteOrder = _BYTE_ORDER_;
+  h.nVars = mx->n_vars;
+  h.format = mx->format;
+  h.problemType = mx->problem_type;
+  h.hasProducts = mx->has_products;
+  h.proofLogId = mx->proof_log_id;
+  h.hardWeight = mx->hard_weight;
+  h.sumSoftWeight = mx->sum_soft_weight;
+  h.maxSoftWeight = mx->max_soft_weight;
+
+  // clauses
+  const std::vector<int64_t> &hardEnds = mx->hard_ends;
+  const std::vector<Lit> &hardLits = mx->hard_lits;
+  vec<int64_t> softEnds;
+  vec<Lit> softLits;
+  vec<uint64_t> softWeights;
+  vec<Lit> softRelax;
+  for (int i = 0; i < mx->nSoft(); i++) {
+    Soft &soft = mx->getSoftClause(i);
+    for (int j = 0; j < soft.clause.size(); j++)
+      softLits.push(soft.clause[j]);
+    softEnds.push(softLits.size());
+    softWeights.push(soft.weight);
+    softRelax.push(soft.relaxation_vars.size() > 0 ? soft.relaxation_vars[0]
+                                                   : lit_Undef);
+  }
+  h.nHard = hardEnds.size();
+  h.nHardLits = hardLits.size();
+  h.nInputClauses = mx->n_input_clauses;
+  h.nSoft = softEnds.size();
+  h.nSoftLits = softLits.size();
+
+  // variable names
+  vec<int32_t> varMap;
+  for (varMap::const_iterator it = mx->_varMap.begin();
+       it != mx->_varMap.end(); ++it) {
+    varMap.push(it->first);
+    varMap.push(it->second);
+  }
+  NameTable &names = mx->_names;
+  h.nVarMap = mx->_varMap.size();
+  h.nIndexToVar = names._indexToVar.size();
+  h.nRef = names._ref.size();
+  h.nPool = names._pool.size();
+  h.nSlots = names._slots.size();
+  h.nNames = names._count;
+  h.nArbitrary = names._arbitrary;
+
+  // constraints
+  vec<CardRecord> cards;
+  vec<Lit> cardLits;
+  for (int i = 0; i < mx->nCard(); i++) {
+    Card *c = mx->getCardinalityConstraint(i);
+    for (int j = 0; j < c->_lits.size(); j++)
+      cardLits.push(c->_lits[j]);
+    CardRecord r = {c->_rhs, c->divisor, cardLits.size(), c->_sign, c->_id};
+    cards.push(r);
+  }
+  vec<PBRecord> pbs;
+  vec<Lit> pbLits;
+  vec<int64_t> pbCoeffs;
+  std::string bigs;
+  for (int i = 0; i < mx->nPB(); i++) {
+    PB *p = mx->getPBConstraint(i);
+    for (int j = 0; j < p->_lits.size(); j++) {
+      pbLits.push(p->_lits[j]);
+      pbCoeffs.push(p->_coeffs[j]);
+    }
+    int64_t bigEnd = -1;
+    if (p->_big != NULL) {
+      // null terminated decimal rhs followed by the coefficients
+      bigs += p->_big->rhs.get_str();
+      bigs += '\0';
+      for (size_t j = 0; j < p->_big->coeffs.size(); j++) {
+        bigs += p->_big->coeffs[j].get_str();
+        bigs += '\0';
+      }
+      bigEnd = bigs.size();
+    }
+    PBRecord r = {p->_rhs,    p->divisor, pbLits.size(),
+                  bigEnd,     p->_sign,   p->_id};
+    pbs.push(r);
+  }
+  h.nCard = cards.size();
+  h.nCardLits = cardLits.size();
+  h.nPB = pbs.size();
+  h.nPBLits = pbLits.size();
+  h.nBigChars = bigs.size();
+
+  SnapshotWriter out;
+  out.fileName = fileName;
+  out.file = fopen(fileName, "wb");
+  if (out.file == NULL)
+    snapshotError("Unable to open output file", fileName);
+  out.write(&h, sizeof(Header));
+  out.write(hardEnds);
+  out.write(hardLits);
+  out.write(softEnds);
+  out.write(softLits);
+  out.write(softWeights);
+  out.write(softRelax);
+  out.write(varMap);
+  out.write(names._indexToVar);
+  out.write(names._ref);
+  out.write(names._pool);
+  out.write(names._slots);
+  out.write(cards);
+  out.write(cardLits);
+  out.write(pbs);
+  out.write(pbLits);
+  out.write(pbCoeffs);
+  out.write(bigs.data(), bigs.size());
+  if (fclose(out.file) != 0)
+    snapshotError("Unable to write snapshot file", fileName);
+}
+
+//! Load a snapshot file into an empty formula. The arrays of the file are
+// copied out of the memory map, which is released at the end; the clauses
+// and constraints are created with their exact sizes.
+
+off_t Snapshot::load(MaxSATFormula *mx, const char *fileName) {
+  assert(mx->nVars() == 0 && mx->nHard() == 0 && mx->nConstr() == 0);
+  int fd = open(fileName, O_RDONLY);
+  if (fd < 0)
+    snapshotError("Unable to open snapshot file", fileName);
+  struct stat statbuf;
+  if (fstat(fd, &statbuf) < 0)
+    snapshotError("Unable to get size of snapshot file", fileName);
+  off_t size = statbuf.st_size;
+  if ((size_t)size < sizeof(Header))
+    snapshotError("Truncated snapshot file", fileName);
+  char *map = (char *)mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (map == (char *)MAP_FAILED)
+    snapshotError("Unable to put in memory snapshot file", fileName);
+  madvise(map, size, MADV_SEQUENTIAL);
+
+  SnapshotReader in;
+  in.pos = map;
+  in.end = map + size;
+  in.fileName = fileName;
+  const Header &h = *in.read<Header>(1);
+  if (memcmp(h.magic, _MAGIC_, sizeof(_MAGIC_)) != 0)
+    snapshotError("Not a snapshot file", fileName);
+  if (h.version != _VERSION_ || h.byteOrder != _BYTE_ORDER_)
+    snapshotError("Snapshot written by an incompatible version or machine",
+                  fileName);
+
+  if (h.nVars < 0)
+    snapshotError("Corrupted snapshot file", fileName);
+  mx->n_vars = h.nVars;
+  mx->format = h.format;
+  mx->problem_type = h.problemType;
+  mx->has_products = h.hasProducts != 0;
+  mx->proof_log_id = h.proofLogId;
+  mx->hard_weight = h.hardWeight;
+  mx->sum_soft_weight = h.sumSoftWeight;
+  mx->max_soft_weight = h.maxSoftWeight;
+
+  // clauses
+  const int64_t *hardEnds = in.read<int64_t>(h.nHard);
+  const Lit *hardLits = in.read<Lit>(h.nHardLits);
+  for (int64_t i = 0, begin = 0; i < h.nHard; begin = hardEnds[i++]) {
+    if (hardEnds[i] < begin || hardEnds[i] > h.nHardLits ||
+        hardEnds[i] - begin > INT_MAX)
+      snapshotError("Corrupted snapshot file", fileName);
+  }
+  checkLits(hardLits, h.nHardLits, h.nVars, fileName);
+  mx->hard_lits.assign(hardLits, hardLits + h.nHardLits);
+  mx->hard_ends.assign(hardEnds, hardEnds + h.nHard);
+  mx->n_hard = h.nHard;
+  if (h.nInputClauses < 0 || h.nInputClauses > h.nHard)
+    snapshotError("Corrupted snapshot file", fileName);
+  mx->n_input_clauses = h.nInputClauses;
+
+  const int64_t *softEnds = in.read<int64_t>(h.nSoft);
+  const Lit *softLits = in.read<Lit>(h.nSoftLits);
+  const uint64_t *softWeights = in.read<uint64_t>(h.nSoft);
+  const Lit *softRelax = in.read<Lit>(h.nSoft);
+  checkLits(softLits, h.nSoftLits, h.nVars, fileName);
+  for (int64_t i = 0; i < h.nSoft; i++)
+    if (softRelax[i] != lit_Undef)
+      checkLits(&softRelax[i], 1, h.nVars, fileName);
+  vec<Lit> lits;
+  vec<Lit> relax;
+  mx->soft_clauses.capacity(h.nSoft);
+  for (int64_t i = 0, begin = 0; i < h.nSoft; begin = softEnds[i++]) {
+    if (softEnds[i] < begin || softEnds[i] > h.nSoftLits)
+      snapshotError("Corrupted snapshot file", fileName);
+    lits.clear();
+    for (int64_t j = begin; j < softEnds[i]; j++)
+      lits.push(softLits[j]);
+    relax.clear();
+    if (softRelax[i] != lit_Undef)
+      relax.push(softRelax[i]);
+    mx->addSoftClause(softWeights[i], lits, relax);
+  }
+
+  // variable names
+  const int32_t *varMap = in.read<int32_t>(2 * h.nVarMap);
+  for (int64_t i = 0; i < h.nVarMap; i++)
+    if (varMap[2 * i] < 0 || varMap[2 * i] >= h.nVars || varMap[2 * i + 1] <= 0)
+      snapshotError("Corrupted snapshot file", fileName);
+  for (int64_t i = 0; i < h.nVarMap; i++)
+    mx->_varMap.insert(mx->_varMap.end(),
+                       std::pair<int, int>(varMap[2 * i], varMap[2 * i + 1]));
+  NameTable &names = mx->_names;
+  in.read(names._indexToVar, h.nIndexToVar);
+  in.read(names._ref, h.nRef);
+  in.read(names._pool, h.nPool);
+  in.read(names._slots, h.nSlots);
+  names._count = h.nNames;
+  names._arbitrary = h.nArbitrary;
+  if (!names.isValid(h.nVars))
+    snapshotError("Corrupted snapshot file", fileName);
+
+  // constraints
+  const CardRecord *cards = in.read<CardRecord>(h.nCard);
+  const Lit *cardLits = in.read<Lit>(h.nCardLits);
+  checkLits(cardLits, h.nCardLits, h.nVars, fileName);
+  mx->cardinality_constraints.capacity(h.nCard);
+  for (int64_t i = 0, begin = 0; i < h.nCard; begin = cards[i++].end) {
+    const CardRecord &r = cards[i];
+    if (r.end < begin || r.end > h.nCardLits)
+      snapshotError("Corrupted snapshot file", fileName);
+    Card *c = new Card();
+    c->_lits.capacity(r.end - begin);
+    for (int64_t j = begin; j < r.end; j++)
+      c->_lits.push(cardLits[j]);
+    c->_rhs = r.rhs;
+    c->_sign = (pb_Sign)r.sign;
+    c->_id = r.id;
+    c->divisor = r.divisor;
+    mx->cardinality_constraints.push(c);
+  }
+
+  const PBRecord *pbs = in.read<PBRecord>(h.nPB);
+  const Lit *pbLits = in.read<Lit>(h.nPBLits);
+  const int64_t *pbCoeffs = in.read<int64_t>(h.nPBLits);
+  const char *bigs = in.read<char>(h.nBigChars);
+  checkLits(pbLits, h.nPBLits, h.nVars, fileName);
+  mx->pb_constraints.capacity(h.nPB);
+  int64_t bigBegin = 0;
+  for (int64_t i = 0, begin = 0; i < h.nPB; begin = pbs[i++].end) {
+    const PBRecord &r = pbs[i];
+    if (r.end < begin || r.end > h.nPBLits || r.bigEnd > h.nBigChars ||
+        (r.bigEnd >= 0 && (r.bigEnd <= bigBegin || bigs[r.bigEnd - 1] != '\0')))
+      snapshotError("Corrupted snapshot file", fileName);
+    PB *p = new PB();
+    p->_lits.capacity(r.end - begin);
+    p->_coeffs.capacity(r.end - begin);
+    for (int64_t j = begin; j < r.end; j++) {
+      p->_lits.push(pbLits[j]);
+      p->_coeffs.push(pbCoeffs[j]);
+    }
+    p->updateCoeffStats();
+    p->_rhs = r.rhs;
+    p->_sign = (pb_Sign)r.sign;
+    p->_id = r.id;
+    p->divisor = r.divisor;
+    if (r.bigEnd >= 0) {
+      p->_big = new PBBig();
+      const char *s = bigs + bigBegin;
+      p->_big->rhs = mpz_class(s);
+      for (int j = 0; j < p->_lits.size(); j++) {
+        s += strlen(s) + 1;
+        if (s >= bigs + r.bigEnd)
+          snapshotError("Corrupted snapshot file", fileName);
+        p->_big->coeffs.push_back(mpz_class(s));
+      }
+      bigBegin = r.bigEnd;
+    }
+    mx->pb_constraints.push(p);
+  }
+
+  munmap(map, size);
+  close(fd);
+  return size;
+}
@@ -0,0 +1,123 @@
+/*!
+ * \author Ruben Martins - rubenm@andrew.cmu.edu
+ *
+ * @section LICENSE
+ *
+ * VeritasPBLib, Copyright (c) 2021-2022, Stephan Gocht, Andy Oertel
+ *                                        Ruben Martins, Jakob Nordstrom
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+#ifndef Snapshot_h
+#define Snapshot_h
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "MaxSATFormula.h"
+
+namespace openwbo {
+
+/*! Binary snapshot of a parsed formula.
+ *
+ * Stores everything the encoders and the output need: the variables, the name
+ * table, the hard and soft clauses, the cardinality and PB constraints with
+ * their proof log ids, and the next proof log id. A snapshot is written after
+ * the input was parsed and normalized, so loading it skips the parser.
+ *
+ * The file is a header followed by flat arrays, each aligned to 8 bytes. It
+ * is read through a memory map and the data is copied out of the map into the
+ * formula: the clause arena in one piece, the soft clauses, the names and the
+ * constraints with their exact sizes. Literals are checked against the number
+ * of variables and the name table against the variables and its pool.
+ * Snapshots use the byte order of the machine that wrote them.
+ */
+class Snapshot {
+
+public:
+  /*! Writes the formula to fileName. */
+  static void save(MaxSATFormula *mx, const char *fileName);
+
+  /*! Loads a formula written by save into an empty formula and returns the
+   * size of the file. */
+  static off_t load(MaxSATFormula *mx, const char *fileName);
+
+protected:
+  static const uint32_t _VERSION_ = 4;
+  static const uint32_t _BYTE_ORDER_ = 0x01020304;
+
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+
+    int32_t nVars;
+    int32_t format;
+    int32_t problemType;
+    int32_t hasProducts;
+    int64_t proofLogId;
+    uint64_t hardWeight;
+    uint64_t sumSoftWeight;
+    uint64_t maxSoftWeight;
+
+    int64_t nHard;
+    int64_t nHardLits;
+    int64_t nInputClauses;
+    int64_t nSoft;
+    int64_t nSoftLits;
+    int64_t nVarMap;
+    int64_t nIndexToVar;
+    int64_t nRef;
+    int64_t nPool;
+    int64_t nSlots;
+    int32_t nNames;
+    int32_t nArbitrary;
+    int64_t nCard;
+    int64_t nCardLits;
+    int64_t nPB;
+    int64_t nPBLits;
+    int64_t nBigChars;
+  };
+
+  // Cardinality and PB constraints. The literals of constraint i are
+  // [end of i-1, end of i) in the literal array of their kind.
+  struct CardRecord {
+    int64_t rhs;
+    int64_t divisor;
+    int64_t end;
+    int64_t sign;
+    int64_t id;
+  };
+
+  struct PBRecord {
+    int64_t rhs;
+    int64_t divisor;
+    int64_t end;
+    int64_t bigEnd; // end of the decimal big numbers or -1
+    int64_t sign;
+    int64_t id;
+  };
+};
+
+} // namespace openwbo
+
+#endif
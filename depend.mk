@@ -0,0 +1,144 @@
+/root/repo/Encoder.o /root/repo/Encoder.or /root/repo/Encoder.od /root/repo/Encoder.op: /root/repo/Encoder.cc /root/repo/Encoder.h \
+ /root/repo/solvers/minisat2.2/core/Solver.h \
+ /root/repo/solvers/minisat2.2/mtl/Vec.h \
+ /root/repo/solvers/minisat2.2/mtl/IntTypes.h \
+ /root/repo/solvers/minisat2.2/mtl/XAlloc.h \
+ /root/repo/solvers/minisat2.2/mtl/Heap.h \
+ /root/repo/solvers/minisat2.2/mtl/Alg.h \
+ /root/repo/solvers/minisat2.2/utils/Options.h \
+ /root/repo/solvers/minisat2.2/utils/ParseUtils.h \
+ /root/repo/solvers/minisat2.2/core/SolverTypes.h \
+ /root/repo/solvers/minisat2.2/mtl/Map.h \
+ /root/repo/solvers/minisat2.2/mtl/Alloc.h /root/repo/MaxTypes.h \
+ /root/repo/encodings/USequential.h /root/repo/encodings/Encodings.h \
+ /root/repo/encodings/../MaxSATFormula.h \
+ /root/repo/encodings/../FormulaPB.h /root/repo/encodings/../MaxTypes.h \
+ /root/repo/encodings/../FormulaVeriPB.h \
+ /root/repo/encodings/../OutputStream.h \
+ /root/repo/encodings/../NameTable.h \
+ /root/repo/encodings/../OccurrenceIndex.h \
+ /root/repo/encodings/../MaxTypes.h /root/repo/encodings/UTotalizer.h \
+ /root/repo/encodings/UAdder.h /root/repo/encodings/VSequential.h \
+ /root/repo/encodings/../FormulaVeriPB.h /root/repo/MaxSATFormula.h
+/root/repo/InputStream.o /root/repo/InputStream.or /root/repo/InputStream.od /root/repo/InputStream.op: /root/repo/InputStream.cc /root/repo/InputStream.h
+/root/repo/Main.o /root/repo/Main.or /root/repo/Main.od /root/repo/Main.op: /root/repo/Main.cc /root/repo/solvers/minisat2.2/utils/Options.h \
+ /root/repo/solvers/minisat2.2/mtl/IntTypes.h \
+ /root/repo/solvers/minisat2.2/mtl/Vec.h \
+ /root/repo/solvers/minisat2.2/mtl/XAlloc.h \
+ /root/repo/solvers/minisat2.2/utils/ParseUtils.h \
+ /root/repo/solvers/minisat2.2/utils/System.h \
+ /root/repo/solvers/minisat2.2/core/Solver.h \
+ /root/repo/solvers/minisat2.2/mtl/Heap.h \
+ /root/repo/solvers/minisat2.2/mtl/Alg.h \
+ /root/repo/solvers/minisat2.2/core/SolverTypes.h \
+ /root/repo/solvers/minisat2.2/mtl/Map.h \
+ /root/repo/solvers/minisat2.2/mtl/Alloc.h /root/repo/MaxSAT.h \
+ /root/repo/MaxSATFormula.h /root/repo/FormulaPB.h /root/repo/MaxTypes.h \
+ /root/repo/FormulaVeriPB.h /root/repo/OutputStream.h \
+ /root/repo/NameTable.h /root/repo/OccurrenceIndex.h \
+ /root/repo/ParserMaxSAT.h /root/repo/ParserPB.h /root/repo/InputStream.h \
+ /root/repo/Snapshot.h /root/repo/encodings/Encodings.h \
+ /root/repo/encodings/../MaxSATFormula.h \
+ /root/repo/encodings/../MaxTypes.h
+/root/repo/MaxSAT.o /root/repo/MaxSAT.or /root/repo/MaxSAT.od /root/repo/MaxSAT.op: /root/repo/MaxSAT.cc /root/repo/MaxSAT.h \
+ /root/repo/solvers/minisat2.2/core/Solver.h \
+ /root/repo/solvers/minisat2.2/mtl/Vec.h \
+ /root/repo/solvers/minisat2.2/mtl/IntTypes.h \
+ /root/repo/solvers/minisat2.2/mtl/XAlloc.h \
+ /root/repo/solvers/minisat2.2/mtl/Heap.h \
+ /root/repo/solvers/minisat2.2/mtl/Alg.h \
+ /root/repo/solvers/minisat2.2/utils/Options.h \
+ /root/repo/solvers/minisat2.2/utils/ParseUtils.h \
+ /root/repo/solvers/minisat2.2/core/SolverTypes.h \
+ /root/repo/solvers/minisat2.2/mtl/Map.h \
+ /root/repo/solvers/minisat2.2/mtl/Alloc.h /root/repo/MaxSATFormula.h \
+ /root/repo/FormulaPB.h /root/repo/MaxTypes.h /root/repo/FormulaVeriPB.h \
+ /root/repo/OutputStream.h /root/repo/NameTable.h \
+ /root/repo/OccurrenceIndex.h \
+ /root/repo/solvers/minisat2.2/utils/System.h
+/root/repo/MaxSATFormula.o /root/repo/MaxSATFormula.or /root/repo/MaxSATFormula.od /root/repo/MaxSATFormula.op: /root/repo/MaxSATFormula.cc /root/repo/MaxSATFormula.h \
+ /root/repo/solvers/minisat2.2/core/Solver.h \
+ /root/repo/solvers/minisat2.2/mtl/Vec.h \
+ /root/repo/solvers/minisat2.2/mtl/IntTypes.h \
+ /root/repo/solvers/minisat2.2/mtl/XAlloc.h \
+ /root/repo/solvers/minisat2.2/mtl/Heap.h \
+ /root/repo/solvers/minisat2.2/mtl/Alg.h \
+ /root/repo/solvers/minisat2.2/utils/Options.h \
+ /root/repo/solvers/minisat2.2/utils/ParseUtils.h \
+ /root/repo/solvers/minisat2.2/core/SolverTypes.h \
+ /root/repo/solvers/minisat2.2/mtl/Map.h \
+ /root/repo/solvers/minisat2.2/mtl/Alloc.h /root/repo/FormulaPB.h \
+ /root/repo/MaxTypes.h /root/repo/FormulaVeriPB.h \
+ /root/repo/OutputStream.h /root/repo/NameTable.h \
+ /root/repo/OccurrenceIndex.h
+/root/repo/NameTable.o /root/repo/NameTable.or /root/repo/NameTable.od /root/repo/NameTable.op: /root/repo/NameTable.cc /root/repo/NameTable.h \
+ /root/repo/solvers/minisat2.2/core/SolverTypes.h \
+ /root/repo/solvers/minisat2.2/mtl/IntTypes.h \
+ /root/repo/solvers/minisat2.2/mtl/Alg.h \
+ /root/repo/solvers/minisat2.2/mtl/Vec.h \
+ /root/repo/solvers/minisat2.2/mtl/XAlloc.h \
+ /root/repo/solvers/minisat2.2/mtl/Map.h \
+ /root/repo/solvers/minisat2.2/mtl/Alloc.h
+/root/repo/OccurrenceIndex.o /root/repo/OccurrenceIndex.or /root/repo/OccurrenceIndex.od /root/repo/OccurrenceIndex.op: /root/repo/OccurrenceIndex.cc \
+ /root/repo/OccurrenceIndex.h \
+ /root/repo/solvers/minisat2.2/core/SolverTypes.h \
+ /root/repo/solvers/minisat2.2/mtl/IntTypes.h \
+ /root/repo/solvers/minisat2.2/mtl/Alg.h \
+ /root/repo/solvers/minisat2.2/mtl/Vec.h \
+ /root/repo/solvers/minisat2.2/mtl/XAlloc.h \
+ /root/repo/solvers/minisat2.2/mtl/Map.h \
+ /root/repo/solvers/minisat2.2/mtl/Alloc.h /root/repo/MaxSATFormula.h \
+ /root/repo/solvers/minisat2.2/core/Solver.h \
+ /root/repo/solvers/minisat2.2/mtl/Heap.h \
+ /root/repo/solvers/minisat2.2/utils/Options.h \
+ /root/repo/solvers/minisat2.2/utils/ParseUtils.h /root/repo/FormulaPB.h \
+ /root/repo/MaxTypes.h /root/repo/FormulaVeriPB.h \
+ /root/repo/OutputStream.h /root/repo/NameTable.h
+/root/repo/OutputStream.o /root/repo/OutputStream.or /root/repo/OutputStream.od /root/repo/OutputStream.op: /root/repo/OutputStream.cc /root/repo/OutputStream.h
+/root/repo/ParserMaxSAT.o /root/repo/ParserMaxSAT.or /root/repo/ParserMaxSAT.od /root/repo/ParserMaxSAT.op: /root/repo/ParserMaxSAT.cc /root/repo/ParserMaxSAT.h \
+ /root/repo/ParserPB.h /root/repo/InputStream.h \
+ /root/repo/MaxSATFormula.h /root/repo/solvers/minisat2.2/core/Solver.h \
+ /root/repo/solvers/minisat2.2/mtl/Vec.h \
+ /root/repo/solvers/minisat2.2/mtl/IntTypes.h \
+ /root/repo/solvers/minisat2.2/mtl/XAlloc.h \
+ /root/repo/solvers/minisat2.2/mtl/Heap.h \
+ /root/repo/solvers/minisat2.2/mtl/Alg.h \
+ /root/repo/solvers/minisat2.2/utils/Options.h \
+ /root/repo/solvers/minisat2.2/utils/ParseUtils.h \
+ /root/repo/solvers/minisat2.2/core/SolverTypes.h \
+ /root/repo/solvers/minisat2.2/mtl/Map.h \
+ /root/repo/solvers/minisat2.2/mtl/Alloc.h /root/repo/FormulaPB.h \
+ /root/repo/MaxTypes.h /root/repo/FormulaVeriPB.h \
+ /root/repo/OutputStream.h /root/repo/NameTable.h \
+ /root/repo/OccurrenceIndex.h
+/root/repo/ParserPB.o /root/repo/ParserPB.or /root/repo/ParserPB.od /root/repo/ParserPB.op: /root/repo/ParserPB.cc /root/repo/ParserPB.h \
+ /root/repo/InputStream.h /root/repo/MaxSATFormula.h \
+ /root/repo/solvers/minisat2.2/core/Solver.h \
+ /root/repo/solvers/minisat2.2/mtl/Vec.h \
+ /root/repo/solvers/minisat2.2/mtl/IntTypes.h \
+ /root/repo/solvers/minisat2.2/mtl/XAlloc.h \
+ /root/repo/solvers/minisat2.2/mtl/Heap.h \
+ /root/repo/solvers/minisat2.2/mtl/Alg.h \
+ /root/repo/solvers/minisat2.2/utils/Options.h \
+ /root/repo/solvers/minisat2.2/utils/ParseUtils.h \
+ /root/repo/solvers/minisat2.2/core/SolverTypes.h \
+ /root/repo/solvers/minisat2.2/mtl/Map.h \
+ /root/repo/solvers/minisat2.2/mtl/Alloc.h /root/repo/FormulaPB.h \
+ /root/repo/MaxTypes.h /root/repo/FormulaVeriPB.h \
+ /root/repo/OutputStream.h /root/repo/NameTable.h \
+ /root/repo/OccurrenceIndex.h /root/repo/solvers/minisat2.2/mtl/Sort.h
+/root/repo/Snapshot.o /root/repo/Snapshot.or /root/repo/Snapshot.od /root/repo/Snapshot.op: /root/repo/Snapshot.cc /root/repo/Snapshot.h \
+ /root/repo/MaxSATFormula.h /root/repo/solvers/minisat2.2/core/Solver.h \
+ /root/repo/solvers/minisat2.2/mtl/Vec.h \
+ /root/repo/solvers/minisat2.2/mtl/IntTypes.h \
+ /root/repo/solvers/minisat2.2/mtl/XAlloc.h \
+ /root/repo/solvers/minisat2.2/mtl/Heap.h \
+ /root/repo/solvers/minisat2.2/mtl/Alg.h \
+ /root/repo/solvers/minisat2.2/utils/Options.h \
+ /root/repo/solvers/minisat2.2/utils/ParseUtils.h \
+ /root/repo/solvers/minisat2.2/core/SolverTypes.h \
+ /root/repo/solvers/minisat2.2/mtl/Map.h \
+ /root/repo/solvers/minisat2.2/mtl/Alloc.h /root/repo/FormulaPB.h \
+ /root/repo/MaxTypes.h /root/repo/FormulaVeriPB.h \
+ /root/repo/OutputStream.h /root/repo/NameTable.h \
+ /root/repo/OccurrenceIndex.h
@@ -36,9 +36,18 @@
 #include "VSequential.h"
 #include "VTotalizer.h"
 
+#include <algorithm>
+
 using namespace openwbo;
 
 void Encodings::encode(Card *card, MaxSATFormula *maxsat_formula, bool proof) {
+  // both encodings use at least about 2nk clauses for the smaller side k
+  int64_t n = card->_lits.size();
+  int64_t k = std::max((int64_t)0, std::min(card->_rhs, n - card->_rhs));
+  reserveClauses(maxsat_formula,
+                 (card->_sign == _PB_EQUAL_ ? 4 : 2) * n * (k + 1));
+  if (card->divisor > 1)
+    card->_id = deriveDivision(maxsat_formula, card, card->_id, card->_sign);
 
   if (_cardinality_type == _CARD_SEQUENTIAL_) {
     USequential seq;
@@ -57,31 +66,57 @@ void Encodings::encode(Card *card, MaxSATFormula *maxsat_formula, bool proof) {
 }
 
 void Encodings::encode(PB *pb, MaxSATFormula *maxsat_formula, bool proof) {
+  if (pb->divisor > 1)
+    pb->_id = deriveDivision(maxsat_formula, pb, pb->_id, pb->_sign);
+
   // saturate constraint
-  PBPp *pbp_saturate = new PBPp(maxsat_formula->getIncProofLogId());
-  pbp_saturate->saturation(pb->_id);
+  PBPp pbp_saturate(maxsat_formula->getProofBuffer(),
+                    maxsat_formula->getIncProofLogId());
+  pbp_saturate.saturation(pb->_id);
   maxsat_formula->addProofExpr(pb, pbp_saturate);
   if (pb->_sign == _PB_EQUAL_) {
-    PBPp *pbp_saturate_eq = new PBPp(maxsat_formula->getIncProofLogId());
-    pbp_saturate_eq->saturation(pb->_id + 1);
+    PBPp pbp_saturate_eq(maxsat_formula->getProofBuffer(),
+                         maxsat_formula->getIncProofLogId());
+    pbp_saturate_eq.saturation(pb->_id + 1);
     maxsat_formula->addProofExpr(pb, pbp_saturate_eq);
   }
-  pb->_id = pbp_saturate->_ctrid;
+  pb->_id = pbp_saturate._ctrid;
 
-  if (pb->_sign == _PB_GREATER_OR_EQUAL_) {
-    for (int i = 0; i < pb->_coeffs.size(); i++) {
-      if (pb->_coeffs[i] > pb->_rhs) {
-        pb->_coeffs[i] = pb->_rhs;
-      }
+  if (pb->_big != NULL) {
+    // clamp the exact coefficients; most constraints fit into 64 bits again
+    mpz_class limit = pb->_big->rhs;
+    if (pb->_sign != _PB_GREATER_OR_EQUAL_)
+      limit += 1;
+    for (size_t i = 0; i < pb->_big->coeffs.size(); i++) {
+      if (pb->_big->coeffs[i] > limit)
+        pb->_big->coeffs[i] = limit;
     }
+    pb->shrinkBig();
   }
 
-  if (pb->_sign == _PB_LESS_OR_EQUAL_ || pb->_sign == _PB_EQUAL_) {
+  if (pb->_big != NULL) {
+    // only the adder is implemented with arbitrary precision
+    VAdder add(proof);
+    add.encode(pb, maxsat_formula);
+    return;
+  }
+
+  int64_t limit = pb->_sign == _PB_GREATER_OR_EQUAL_ ? pb->_rhs : pb->_rhs + 1;
+  if (pb->coeffMax() > limit) {
     for (int i = 0; i < pb->_coeffs.size(); i++) {
-      if (pb->_coeffs[i] > pb->_rhs + 1) {
-        pb->_coeffs[i] = pb->_rhs + 1;
+      if (pb->_coeffs[i] > limit) {
+        pb->_coeffs[i] = limit;
       }
     }
+    pb->updateCoeffStats();
+  }
+
+  if (_pb_type == _PB_ADDER_ || _pb_type == _PB_VADDER_) {
+    // each full adder takes about 20 clauses and removes two input bits
+    int64_t bits = 0;
+    for (int i = 0; i < pb->_coeffs.size(); i++)
+      bits += __builtin_popcountll(pb->_coeffs[i]);
+    reserveClauses(maxsat_formula, 10 * bits);
   }
 
   if (_pb_type == _PB_GTE_) {
@@ -100,6 +135,29 @@ void Encodings::encode(PB *pb, MaxSATFormula *maxsat_formula, bool proof) {
     assert(false);
 }
 
+// Derives the constraint that was divided by the GCD of its coefficients when
+// it was parsed and returns its id. Both halves of equalities are divided and
+// keep consecutive ids.
+int64_t Encodings::deriveDivision(MaxSATFormula *mx, Constraint *ctr,
+                                  int64_t id, pb_Sign sign) {
+  PBPp pbp(mx->getProofBuffer(), mx->getIncProofLogId());
+  pbp.division(id, ctr->divisor);
+  mx->addProofExpr(ctr, pbp);
+  if (sign == _PB_EQUAL_) {
+    PBPp pbp_eq(mx->getProofBuffer(), mx->getIncProofLogId());
+    pbp_eq.division(id + 1, ctr->divisor);
+    mx->addProofExpr(ctr, pbp_eq);
+  }
+  return pbp._ctrid;
+}
+
+// Reserves space for the estimated number of clauses of a constraint. The
+// estimate is capped since it is only a hint.
+void Encodings::reserveClauses(MaxSATFormula *mx, int64_t estimate) {
+  int n = (int)std::min(estimate, (int64_t)_MAX_CLAUSE_RESERVE_);
+  mx->reserveHardClauses(n);
+}
+
 void Encodings::addUnitClause(MaxSATFormula *mx, Constraint *ctr, Lit a) {
   assert(clause.size() == 0);
   assert(a != lit_Undef);
@@ -150,95 +208,96 @@ void Encodings::addClause(MaxSATFormula *mx, Constraint *ctr, vec<Lit> &c) {
   mx->addHardClause(ctr, c);
 }
 
-std::pair<PBPred *, PBPred *> Encodings::reify(Constraint *ctr, Lit z, PB *pb) {
-  vec<Lit> lits;
-  vec<int64_t> coeffs;
-  int64_t sum = 0;
-  for (int i = 0; i < pb->_lits.size(); i++) {
-    lits.push(~pb->_lits[i]);
-    coeffs.push(pb->_coeffs[i]);
-    sum += pb->_coeffs[i];
-  }
+// The steps are written to the proof right away, so pb can be a temporary.
+// pb must not be reified_leq, which is reused for the second step.
+std::pair<PBPred, PBPred> Encodings::reify(Constraint *ctr, Lit z, PB *pb) {
+  int64_t sum = pb->coeffSum();
+  PB &pb_leq = reified_leq;
+  pb_leq.clear();
+  for (int i = 0; i < pb->_lits.size(); i++)
+    pb_leq.addProduct(~pb->_lits[i], pb->_coeffs[i]);
+  pb_leq._rhs = sum - pb->_rhs + 1;
+  pb_leq._sign = _PB_GREATER_OR_EQUAL_;
 
   pb->addProduct(~z, pb->_rhs);
-  PBPred *pbp_geq = new PBPred(mx->getIncProofLogId(), pb, var(z) + 1, 0);
+  PBPred pbp_geq(mx->getIncProofLogId(), pb, var(z), 0);
   mx->addProofExpr(ctr, pbp_geq);
 
-  PB *pb_leq = new PB(lits, coeffs, sum - pb->_rhs + 1, _PB_GREATER_OR_EQUAL_);
-  pb_leq->addProduct(z, sum - pb->_rhs + 1);
-  PBPred *pbp_leq = new PBPred(mx->getIncProofLogId(), pb_leq, var(z) + 1, 1);
+  pb_leq.addProduct(z, pb_leq._rhs);
+  PBPred pbp_leq(mx->getIncProofLogId(), &pb_leq, var(z), 1);
   mx->addProofExpr(ctr, pbp_leq);
 
-  std::pair<PBPred *, PBPred *> res;
+  std::pair<PBPred, PBPred> res;
   res.first = pbp_geq;
   res.second = pbp_leq;
   return res;
 }
 
-void Encodings::derive_ordering(Constraint *ctr, PBPred *p1, PBPred *p2) {
-  int d = 0;
-  for (int i = 0; i < p1->_ctr->_coeffs.size(); i++) {
-    if (var(p1->_ctr->_lits[i]) + 1 != p1->_v)
-      d += p1->_ctr->_coeffs[i];
-  }
-  PBPp *pbp = new PBPp(mx->getIncProofLogId());
-  pbp->addition(p1->_ctrid, p2->_ctrid);
-  pbp->division(d);
+void Encodings::derive_ordering(Constraint *ctr, PBPred &p1, PBPred &p2) {
+  PBPp pbp(mx->getProofBuffer(), mx->getIncProofLogId());
+  pbp.addition(p1._ctrid, p2._ctrid);
+  pbp.division(p1._sum);
   mx->addProofExpr(ctr, pbp);
 }
 
-int Encodings::derive_sum(Constraint *ctr, vec<PBPred *> &sum) {
+int64_t Encodings::derive_sum(Constraint *ctr, vec<PBPred> &sum) {
   if (sum.size() < 2) {
     assert(sum.size() == 1);
-    return sum[0]->_ctrid;
+    return sum[0]._ctrid;
   }
 
-  int c = sum[0]->_ctrid;
+  int64_t c = sum[0]._ctrid;
   for (int j = 2; j <= sum.size(); j++) {
-    PBPp *pbp = new PBPp(mx->getIncProofLogId());
+    PBPp pbp(mx->getProofBuffer(), mx->getIncProofLogId());
     // avoid multiplication by 1
     if (j - 1 == 1)
-      pbp->addition(c, sum[j - 1]->_ctrid);
+      pbp.addition(c, sum[j - 1]._ctrid);
     else {
-      pbp->multiplication(c, j - 1);
-      pbp->addition(sum[j - 1]->_ctrid);
+      pbp.multiplication(c, j - 1);
+      pbp.addition(sum[j - 1]._ctrid);
     }
-    pbp->division(j);
+    pbp.division(j);
     mx->addProofExpr(ctr, pbp);
 
     // not needed but may make the proof easier to read
     if (j != sum.size())
       c = -1;
     else
-      c = pbp->_ctrid;
+      c = pbp._ctrid;
   }
   return c;
 }
 
-std::pair<int, int> Encodings::derive_unary_sum(Constraint *ctr, vec<Lit> &left,
-                                                vec<Lit> &right) {
-  vec<PBPred *> sum_leq;
-  vec<PBPred *> sum_geq;
+std::pair<int64_t, int64_t>
+Encodings::derive_unary_sum(Constraint *ctr, vec<Lit> &left, vec<Lit> &right) {
+  vec<PBPred> sum_leq;
+  vec<PBPred> sum_geq;
 
+  sum_leq.capacity(right.size());
+  sum_geq.capacity(right.size());
   for (int j = 0; j < right.size(); j++) {
     // introduce variables as reification
     // reify(z_j <-> sum^n_i l_i >= j)
-    vec<int64_t> coeffs;
-    coeffs.growTo(left.size(), 1);
-    PB *pb = new PB(left, coeffs, j + 1, _PB_GREATER_OR_EQUAL_);
-    std::pair<PBPred *, PBPred *> p = reify(ctr, right[j], pb);
+    PB &pb = reified;
+    pb.clear();
+    for (int i = 0; i < left.size(); i++)
+      pb.addProduct(left[i], 1);
+    pb._rhs = j + 1;
+    pb._sign = _PB_GREATER_OR_EQUAL_;
+    std::pair<PBPred, PBPred> p = reify(ctr, right[j], &pb);
     sum_geq.push(p.first);
     sum_leq.push(p.second);
   }
 
   // reverse sum_leq
-  vec<PBPred *> sum_leq_rev;
+  vec<PBPred> sum_leq_rev;
+  sum_leq_rev.capacity(sum_leq.size());
   for (int i = sum_leq.size() - 1; i >= 0; i--) {
     sum_leq_rev.push(sum_leq[i]);
   }
 
-  int c_geq = derive_sum(ctr, sum_geq);
-  int c_leq = derive_sum(ctr, sum_leq_rev);
+  int64_t c_geq = derive_sum(ctr, sum_geq);
+  int64_t c_leq = derive_sum(ctr, sum_leq_rev);
 
   for (int i = 0; i < right.size() - 1; i++) {
     if (i + 1 < sum_geq.size()) {
@@ -246,7 +305,7 @@ std::pair<int, int> Encodings::derive_unary_sum(Constraint *ctr, vec<Lit> &left,
     }
   }
 
-  std::pair<int, int> res;
+  std::pair<int64_t, int64_t> res;
   res.first = c_geq;
   res.second = c_leq;
 
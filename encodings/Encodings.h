@@ -35,6 +35,9 @@
 #include "../MaxTypes.h"
 #include "core/SolverTypes.h"
 
+// Upper bound on the number of clauses reserved for a single constraint.
+#define _MAX_CLAUSE_RESERVE_ (1 << 22)
+
 using NSPACE::Lit;
 using NSPACE::lit_Error;
 using NSPACE::lit_Undef;
@@ -64,21 +67,27 @@ public:
   void addQuaternaryClause(MaxSATFormula *mx, Constraint *ctr, Lit a, Lit b,
                            Lit c, Lit d);
   void addClause(MaxSATFormula *mx, Constraint *ctr, vec<Lit> &c);
+  void reserveClauses(MaxSATFormula *mx, int64_t estimate);
+  int64_t deriveDivision(MaxSATFormula *mx, Constraint *ctr, int64_t id,
+                         pb_Sign sign);
   void encode(Card *card, MaxSATFormula *maxsat_formula, bool proof = true);
   void encode(PB *pb, MaxSATFormula *maxsat_formula, bool proof = true);
 
 protected:
   vec<Lit> clause; // Temporary clause to be used while building the encodings.
+  PB reified;      // Temporary constraints to be used while reifying them.
+  PB reified_leq;
   pb_Cardinality _cardinality_type;
   pb_PB _pb_type;
 
   // Auxillary methods for proof logging
   MaxSATFormula *mx;
-  std::pair<PBPred *, PBPred *> reify(Constraint *ctr, Lit z, PB *pb);
-  void derive_ordering(Constraint *ctr, PBPred *p1, PBPred *p2);
-  int derive_sum(Constraint *ctr, vec<PBPred *> &sum);
-  std::pair<int, int> derive_unary_sum(Constraint *ctr, vec<Lit> &left,
-                                       vec<Lit> &right);
+  std::pair<PBPred, PBPred> reify(Constraint *ctr, Lit z, PB *pb);
+  void derive_ordering(Constraint *ctr, PBPred &p1, PBPred &p2);
+  int64_t derive_sum(Constraint *ctr, vec<PBPred> &sum);
+  std::pair<int64_t, int64_t> derive_unary_sum(Constraint *ctr,
+                                               vec<Lit> &left,
+                                               vec<Lit> &right);
 };
 } // namespace openwbo
 
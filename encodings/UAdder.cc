@@ -241,16 +241,8 @@ void UAdder::numToBits(std::vector<uint64_t> &bits, uint64_t n,
 
 void UAdder::encode(PB *pb, MaxSATFormula *maxsat_formula,
                     pb_Sign current_sign) {
-  vec<Lit> lits;
-  uint64_t sum = 0;
-  vec<uint64_t> coeffs;
-
-  pb->_lits.copyTo(lits);
-  for (int i = 0; i < pb->_coeffs.size(); i++) {
-    assert(pb->_coeffs[i] > 0);
-    coeffs.push(pb->_coeffs[i]);
-    sum += pb->_coeffs[i];
-  }
+  TermView lits = pb->view();
+  uint64_t sum = lits.sum();
   uint64_t rhs = pb->_rhs;
 
   // simplifications
@@ -278,9 +270,7 @@ void UAdder::encode(PB *pb, MaxSATFormula *maxsat_formula,
 
   // transform the constraint to consider the smallest rhs
   if (sum - rhs < rhs) {
-    for (int i = 0; i < lits.size(); i++) {
-      lits[i] = ~(lits[i]);
-    }
+    lits = pb->view(true);
     rhs = sum - rhs;
     if (current_sign != _PB_EQUAL_) {
       if (current_sign == _PB_GREATER_OR_EQUAL_)
@@ -299,7 +289,7 @@ void UAdder::encode(PB *pb, MaxSATFormula *maxsat_formula,
     _buckets.push_back(std::queue<Lit>());
     _output.push(u);
     for (int iVar = 0; iVar < lits.size(); ++iVar) {
-      if (((((int64_t)1) << iBit) & coeffs[iVar]) != 0)
+      if (((((int64_t)1) << iBit) & lits.coeff(iVar)) != 0)
         _buckets.back().push(lits[iVar]);
     }
   }
@@ -215,18 +215,10 @@ bool UGTE::encodeLeq(uint64_t k, MaxSATFormula *maxsat_formula, PB *pb,
   return true;
 }
 
-// copies the current PB constraint into new vectors
+// encodes the terms of the current PB constraint through a view
 void UGTE::encode(PB *pb, MaxSATFormula *maxsat_formula, pb_Sign current_sign) {
-  vec<Lit> lits;
-  uint64_t sum = 0;
-  pb->_lits.copyTo(lits);
-
-  vec<uint64_t> coeffs;
-  for (int i = 0; i < pb->_coeffs.size(); i++) {
-    assert(pb->_coeffs[i] > 0);
-    coeffs.push(pb->_coeffs[i]);
-    sum += pb->_coeffs[i];
-  }
+  TermView lits = pb->view();
+  uint64_t sum = lits.sum();
   uint64_t rhs = pb->_rhs;
 
   // simplifications
@@ -254,9 +246,7 @@ void UGTE::encode(PB *pb, MaxSATFormula *maxsat_formula, pb_Sign current_sign) {
 
   // transform the constraint to consider the smallest rhs
   if (sum - rhs < rhs) {
-    for (int i = 0; i < lits.size(); i++) {
-      lits[i] = ~(lits[i]);
-    }
+    lits = pb->view(true);
     rhs = sum - rhs;
     if (current_sign != _PB_EQUAL_) {
       if (current_sign == _PB_GREATER_OR_EQUAL_)
@@ -266,54 +256,43 @@ void UGTE::encode(PB *pb, MaxSATFormula *maxsat_formula, pb_Sign current_sign) {
     }
   }
 
-  encode(maxsat_formula, pb, lits, coeffs, rhs, current_sign);
+  encode(maxsat_formula, pb, lits, rhs, current_sign);
 }
 
-void UGTE::encode(MaxSATFormula *maxsat_formula, PB *pb, vec<Lit> &lits,
-                  vec<uint64_t> &coeffs, uint64_t rhs, pb_Sign current_sign) {
+void UGTE::encode(MaxSATFormula *maxsat_formula, PB *pb, const TermView &lits,
+                  uint64_t rhs, pb_Sign current_sign) {
   if (rhs >= UINT64_MAX) {
     printf("c Overflow in the Encoding\n");
     printf("s UNKNOWN\n");
     exit(_ERROR_);
   }
 
-  vec<Lit> simp_lits;
-  vec<uint64_t> simp_coeffs;
-  lits.copyTo(simp_lits);
-  coeffs.copyTo(simp_coeffs);
-
-  lits.clear();
-  coeffs.clear();
-
   // Fix literals that have a coeff larger than rhs.
-  for (int i = 0; i < simp_lits.size(); i++) {
-    if (simp_coeffs[i] == 0)
+  weightedlitst iliterals;
+  for (int i = 0; i < lits.size(); i++) {
+    uint64_t coeff = lits.coeff(i);
+    if (coeff == 0)
       continue;
 
-    if (simp_coeffs[i] >= UINT64_MAX) {
+    if (coeff >= UINT64_MAX) {
       printf("c Overflow in the Encoding\n");
       printf("s UNKNOWN\n");
       exit(_ERROR_);
     }
 
-    if (simp_coeffs[i] > (unsigned)rhs && current_sign == _PB_LESS_OR_EQUAL_) {
-      addUnitClause(maxsat_formula, pb, ~simp_lits[i]);
+    if (coeff > (unsigned)rhs && current_sign == _PB_LESS_OR_EQUAL_) {
+      addUnitClause(maxsat_formula, pb, ~lits[i]);
     } else {
-      lits.push(simp_lits[i]);
-      coeffs.push(simp_coeffs[i]);
+      wlitt wl;
+      wl.lit = lits[i];
+      wl.weight = coeff;
+      iliterals.push_back(wl);
     }
   }
 
-  if (lits.size() == 0)
+  if (iliterals.size() == 0)
     return;
 
-  weightedlitst iliterals;
-  for (int i = 0; i < lits.size(); i++) {
-    wlitt wl;
-    wl.lit = lits[i];
-    wl.weight = coeffs[i];
-    iliterals.push_back(wl);
-  }
   less_than_wlitt lt_wlit;
   std::sort(iliterals.begin(), iliterals.end(), lt_wlit);
   if (current_sign == _PB_GREATER_OR_EQUAL_) {
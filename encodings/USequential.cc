@@ -31,9 +31,8 @@ using namespace openwbo;
 
 void USequential::encode(Card *card, MaxSATFormula *maxsat_formula,
                          pb_Sign sign) {
-  vec<Lit> lits;
   uint64_t rhs = card->_rhs;
-  card->_lits.copyTo(lits);
+  TermView lits = card->view();
   int n = lits.size();
 
   // >= we need to fix output @rhs with positive literal
@@ -66,12 +65,8 @@ void USequential::encode(Card *card, MaxSATFormula *maxsat_formula,
 
   // transform the constraint to consider the smallest rhs
   if (n - rhs < rhs) {
-    int s = 0;
-    for (int i = 0; i < lits.size(); i++) {
-      s += 1;
-      lits[i] = ~(lits[i]);
-    }
-    rhs = s - rhs;
+    lits = card->view(true);
+    rhs = n - rhs;
     if (current_sign != _PB_EQUAL_) {
       if (current_sign == _PB_GREATER_OR_EQUAL_)
         current_sign = _PB_LESS_OR_EQUAL_;
@@ -111,18 +111,14 @@ void UTotalizer::toCNF(MaxSATFormula *maxsat_formula, Card *card,
 
 void UTotalizer::encode(Card *card, MaxSATFormula *maxsat_formula,
                         pb_Sign sign) {
-  vec<Lit> lits;
-  vec<Lit> pb_outlits;
-  vec<int64_t> coeffs;
   cardinality_outlits.clear();
   cardinality_inlits.clear();
-  card->_lits.copyTo(lits);
+  TermView lits = card->view();
   int n = lits.size();
   _rhs = card->_rhs;
 
   // code adapted from Open-WBO
   // would also support PB constraints using the sequential encoding
-  coeffs.growTo(lits.size(), 1);
   pb_Sign current_sign = sign;
 
   // simplifications
@@ -150,12 +146,8 @@ void UTotalizer::encode(Card *card, MaxSATFormula *maxsat_formula,
 
   // transform the constraint to consider the smallest rhs
   if (n - _rhs < _rhs) {
-    int s = 0;
-    for (int i = 0; i < lits.size(); i++) {
-      s += 1;
-      lits[i] = ~(lits[i]);
-    }
-    _rhs = s - _rhs;
+    lits = card->view(true);
+    _rhs = n - _rhs;
     if (current_sign != _PB_EQUAL_) {
       if (current_sign == _PB_GREATER_OR_EQUAL_)
         current_sign = _PB_LESS_OR_EQUAL_;
@@ -175,7 +167,8 @@ void UTotalizer::encode(Card *card, MaxSATFormula *maxsat_formula,
     cardinality_outlits.push(p);
   }
 
-  lits.copyTo(cardinality_inlits);
+  for (int i = 0; i < lits.size(); i++)
+    cardinality_inlits.push(lits[i]);
 
   toCNF(maxsat_formula, card, cardinality_outlits, k);
   assert(cardinality_inlits.size() == 0);
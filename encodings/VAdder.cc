@@ -107,8 +107,8 @@ void VAdder::adderTree(MaxSATFormula *maxsat_formula, PB *pb,
                        uint64_t log_k, pb_Sign current_sign, bool flipped) {
   Lit x, y, z;
   Lit u = lit_Undef;
-  int current_constr_id_geq = 0;
-  int current_constr_id_leq = 0;
+  int64_t current_constr_id_geq = 0;
+  int64_t current_constr_id_leq = 0;
   if (current_sign == _PB_LESS_OR_EQUAL_ || current_sign == _PB_EQUAL_) {
     if (current_sign == _PB_EQUAL_ && !flipped) {
       current_constr_id_geq = pb->_id + 1;
@@ -133,8 +133,8 @@ void VAdder::adderTree(MaxSATFormula *maxsat_formula, PB *pb,
       result.push(u);
     }
 
-    std::pair<PBPred *, PBPred *> pair_carry;
-    std::pair<PBPred *, PBPred *> pair_sum;
+    std::pair<PBPred, PBPred> pair_carry;
+    std::pair<PBPred, PBPred> pair_sum;
 
     while (buckets[i].size() >= 3) {
       x = buckets[i].front();
@@ -155,9 +155,8 @@ void VAdder::adderTree(MaxSATFormula *maxsat_formula, PB *pb,
         pb_lits_carry.push(y);
         pb_lits_carry.push(z);
         vec<int64_t> coeffs_carry(3, 1);
-        PB *pb_carry =
-            new PB(pb_lits_carry, coeffs_carry, 2, _PB_GREATER_OR_EQUAL_);
-        pair_carry = reify(pb, x_carry, pb_carry);
+        PB pb_carry(pb_lits_carry, coeffs_carry, 2, _PB_GREATER_OR_EQUAL_);
+        pair_carry = reify(pb, x_carry, &pb_carry);
 
         vec<Lit> pb_lits_sum;
         pb_lits_sum.push(x);
@@ -166,34 +165,34 @@ void VAdder::adderTree(MaxSATFormula *maxsat_formula, PB *pb,
         pb_lits_sum.push(~x_carry);
         vec<int64_t> coeffs_sum(3, 1);
         coeffs_sum.push(2);
-        PB *pb_sum = new PB(pb_lits_sum, coeffs_sum, 3, _PB_GREATER_OR_EQUAL_);
-        pair_sum = reify(pb, x_sum, pb_sum);
+        PB pb_sum(pb_lits_sum, coeffs_sum, 3, _PB_GREATER_OR_EQUAL_);
+        pair_sum = reify(pb, x_sum, &pb_sum);
 
         if (current_sign == _PB_LESS_OR_EQUAL_ || current_sign == _PB_EQUAL_) {
-          PBPp *pbp_geq = new PBPp(mx->getIncProofLogId());
-          pbp_geq->multiplication(pair_carry.first->_ctrid, 2);
-          pbp_geq->addition(pair_sum.first->_ctrid);
-          pbp_geq->division(3);
+          PBPp pbp_geq(mx->getProofBuffer(), mx->getIncProofLogId());
+          pbp_geq.multiplication(pair_carry.first._ctrid, 2);
+          pbp_geq.addition(pair_sum.first._ctrid);
+          pbp_geq.division(3);
           mx->addProofExpr(pb, pbp_geq);
-          PBPp *pbp_geq_sum = new PBPp(mx->getIncProofLogId());
-          pbp_geq_sum->multiplication(pbp_geq->_ctrid, 1 << i);
-          pbp_geq_sum->addition(current_constr_id_geq);
+          PBPp pbp_geq_sum(mx->getProofBuffer(), mx->getIncProofLogId());
+          pbp_geq_sum.multiplicationPow2(pbp_geq._ctrid, i);
+          pbp_geq_sum.addition(current_constr_id_geq);
           mx->addProofExpr(pb, pbp_geq_sum);
-          current_constr_id_geq = pbp_geq_sum->_ctrid;
+          current_constr_id_geq = pbp_geq_sum._ctrid;
         }
 
         if (current_sign == _PB_GREATER_OR_EQUAL_ ||
             current_sign == _PB_EQUAL_) {
-          PBPp *pbp_leq = new PBPp(mx->getIncProofLogId());
-          pbp_leq->multiplication(pair_carry.second->_ctrid, 2);
-          pbp_leq->addition(pair_sum.second->_ctrid);
-          pbp_leq->division(3);
+          PBPp pbp_leq(mx->getProofBuffer(), mx->getIncProofLogId());
+          pbp_leq.multiplication(pair_carry.second._ctrid, 2);
+          pbp_leq.addition(pair_sum.second._ctrid);
+          pbp_leq.division(3);
           mx->addProofExpr(pb, pbp_leq);
-          PBPp *pbp_leq_sum = new PBPp(mx->getIncProofLogId());
-          pbp_leq_sum->multiplication(pbp_leq->_ctrid, 1 << i);
-          pbp_leq_sum->addition(current_constr_id_leq);
+          PBPp pbp_leq_sum(mx->getProofBuffer(), mx->getIncProofLogId());
+          pbp_leq_sum.multiplicationPow2(pbp_leq._ctrid, i);
+          pbp_leq_sum.addition(current_constr_id_leq);
           mx->addProofExpr(pb, pbp_leq_sum);
-          current_constr_id_leq = pbp_leq_sum->_ctrid;
+          current_constr_id_leq = pbp_leq_sum._ctrid;
         }
       }
     }
@@ -213,9 +212,8 @@ void VAdder::adderTree(MaxSATFormula *maxsat_formula, PB *pb,
         pb_lits_carry.push(x);
         pb_lits_carry.push(y);
         vec<int64_t> coeffs_carry(2, 1);
-        PB *pb_carry =
-            new PB(pb_lits_carry, coeffs_carry, 2, _PB_GREATER_OR_EQUAL_);
-        pair_carry = reify(pb, x_carry, pb_carry);
+        PB pb_carry(pb_lits_carry, coeffs_carry, 2, _PB_GREATER_OR_EQUAL_);
+        pair_carry = reify(pb, x_carry, &pb_carry);
 
         vec<Lit> pb_lits_sum;
         pb_lits_sum.push(x);
@@ -223,34 +221,34 @@ void VAdder::adderTree(MaxSATFormula *maxsat_formula, PB *pb,
         pb_lits_sum.push(~x_carry);
         vec<int64_t> coeffs_sum(2, 1);
         coeffs_sum.push(2);
-        PB *pb_sum = new PB(pb_lits_sum, coeffs_sum, 3, _PB_GREATER_OR_EQUAL_);
-        pair_sum = reify(pb, x_sum, pb_sum);
+        PB pb_sum(pb_lits_sum, coeffs_sum, 3, _PB_GREATER_OR_EQUAL_);
+        pair_sum = reify(pb, x_sum, &pb_sum);
 
         if (current_sign == _PB_LESS_OR_EQUAL_ || current_sign == _PB_EQUAL_) {
-          PBPp *pbp_geq = new PBPp(mx->getIncProofLogId());
-          pbp_geq->multiplication(pair_carry.first->_ctrid, 2);
-          pbp_geq->addition(pair_sum.first->_ctrid);
-          pbp_geq->division(3);
+          PBPp pbp_geq(mx->getProofBuffer(), mx->getIncProofLogId());
+          pbp_geq.multiplication(pair_carry.first._ctrid, 2);
+          pbp_geq.addition(pair_sum.first._ctrid);
+          pbp_geq.division(3);
           mx->addProofExpr(pb, pbp_geq);
-          PBPp *pbp_geq_sum = new PBPp(mx->getIncProofLogId());
-          pbp_geq_sum->multiplication(pbp_geq->_ctrid, 1 << i);
-          pbp_geq_sum->addition(current_constr_id_geq);
+          PBPp pbp_geq_sum(mx->getProofBuffer(), mx->getIncProofLogId());
+          pbp_geq_sum.multiplicationPow2(pbp_geq._ctrid, i);
+          pbp_geq_sum.addition(current_constr_id_geq);
           mx->addProofExpr(pb, pbp_geq_sum);
-          current_constr_id_geq = pbp_geq_sum->_ctrid;
+          current_constr_id_geq = pbp_geq_sum._ctrid;
         }
 
         if (current_sign == _PB_GREATER_OR_EQUAL_ ||
             current_sign == _PB_EQUAL_) {
-          PBPp *pbp_leq = new PBPp(mx->getIncProofLogId());
-          pbp_leq->multiplication(pair_carry.second->_ctrid, 2);
-          pbp_leq->addition(pair_sum.second->_ctrid);
-          pbp_leq->division(3);
+          PBPp pbp_leq(mx->getProofBuffer(), mx->getIncProofLogId());
+          pbp_leq.multiplication(pair_carry.second._ctrid, 2);
+          pbp_leq.addition(pair_sum.second._ctrid);
+          pbp_leq.division(3);
           mx->addProofExpr(pb, pbp_leq);
-          PBPp *pbp_leq_sum = new PBPp(mx->getIncProofLogId());
-          pbp_leq_sum->multiplication(pbp_leq->_ctrid, 1 << i);
-          pbp_leq_sum->addition(current_constr_id_leq);
+          PBPp pbp_leq_sum(mx->getProofBuffer(), mx->getIncProofLogId());
+          pbp_leq_sum.multiplicationPow2(pbp_leq._ctrid, i);
+          pbp_leq_sum.addition(current_constr_id_leq);
           mx->addProofExpr(pb, pbp_leq_sum);
-          current_constr_id_leq = pbp_leq_sum->_ctrid;
+          current_constr_id_leq = pbp_leq_sum._ctrid;
         }
       }
     }
@@ -341,25 +339,18 @@ void VAdder::numToBits(std::vector<uint64_t> &bits, uint64_t n,
 
 void VAdder::encode(PB *pb, MaxSATFormula *maxsat_formula,
                     pb_Sign current_sign) {
-  vec<Lit> lits;
-  uint64_t sum = 0;
-  vec<uint64_t> coeffs;
-
-  pb->_lits.copyTo(lits);
-  for (int i = 0; i < pb->_coeffs.size(); i++) {
-    assert(pb->_coeffs[i] > 0);
-    coeffs.push(pb->_coeffs[i]);
-    sum += pb->_coeffs[i];
+  if (pb->_big != NULL) {
+    encodeBig(pb, maxsat_formula, current_sign);
+    return;
   }
+
+  uint64_t sum = pb->coeffSum();
   uint64_t rhs = pb->_rhs;
 
   // transform the constraint to consider the smallest rhs
   bool flipped = false;
 
   if (sum - rhs < rhs) {
-    for (int i = 0; i < lits.size(); i++) {
-      lits[i] = ~(lits[i]);
-    }
     rhs = sum - rhs;
     if (current_sign != _PB_EQUAL_) {
       if (current_sign == _PB_GREATER_OR_EQUAL_)
@@ -369,6 +360,7 @@ void VAdder::encode(PB *pb, MaxSATFormula *maxsat_formula,
     }
     flipped = true;
   }
+  TermView lits = pb->view(flipped);
 
   _output.clear();
 
@@ -383,7 +375,7 @@ void VAdder::encode(PB *pb, MaxSATFormula *maxsat_formula,
     _buckets.push_back(std::queue<Lit>());
     _output.push(u);
     for (int iVar = 0; iVar < lits.size(); ++iVar) {
-      if (((((int64_t)1) << iBit) & coeffs[iVar]) != 0)
+      if (((((int64_t)1) << iBit) & lits.coeff(iVar)) != 0)
         _buckets.back().push(lits[iVar]);
     }
   }
@@ -391,7 +383,7 @@ void VAdder::encode(PB *pb, MaxSATFormula *maxsat_formula,
   _buckets.push_back(std::queue<Lit>());
   _output.push(u);
   for (int iVar = 0; iVar < lits.size(); ++iVar) {
-    if (((((uint64_t)1) << (nb + 1)) <= coeffs[iVar]))
+    if (((((uint64_t)1) << (nb + 1)) <= (uint64_t)lits.coeff(iVar)))
       _buckets.back().push(lits[iVar]);
   }
 
@@ -407,7 +399,74 @@ void VAdder::encode(PB *pb, MaxSATFormula *maxsat_formula,
 
   std::vector<uint64_t> kBits;
   numToBits(kBits, _buckets.size(), rhs);
+  compare(maxsat_formula, pb, kBits, current_sign);
+}
+
+// Same as encode but with the arbitrary precision coefficients of pb->_big.
+void VAdder::encodeBig(PB *pb, MaxSATFormula *maxsat_formula,
+                       pb_Sign current_sign) {
+  std::vector<mpz_class> &coeffs = pb->_big->coeffs;
+  mpz_class sum = 0;
+
+  for (size_t i = 0; i < coeffs.size(); i++) {
+    assert(coeffs[i] > 0);
+    sum += coeffs[i];
+  }
+  mpz_class rhs = pb->_big->rhs;
+
+  // transform the constraint to consider the smallest rhs
+  bool flipped = false;
+
+  if (sum - rhs < rhs) {
+    rhs = sum - rhs;
+    if (current_sign != _PB_EQUAL_) {
+      if (current_sign == _PB_GREATER_OR_EQUAL_)
+        current_sign = _PB_LESS_OR_EQUAL_;
+      else
+        current_sign = _PB_GREATER_OR_EQUAL_;
+    }
+    flipped = true;
+  }
+  TermView lits = pb->view(flipped);
+
+  _output.clear();
+
+  assert(rhs > 0 && sum - rhs > 0 && "log undefined for 0");
+  uint64_t nb = mpz_sizeinbase(rhs.get_mpz_t(), 2); // number of bits
+  if (pb->_sign == _PB_EQUAL_ && (sum - rhs) > rhs) {
+    mpz_class diff = sum - rhs;
+    nb = mpz_sizeinbase(diff.get_mpz_t(), 2);
+  }
+  Lit u = lit_Undef;
+
+  for (uint64_t iBit = 0; iBit <= nb; ++iBit) {
+    _buckets.push_back(std::queue<Lit>());
+    _output.push(u);
+    for (int iVar = 0; iVar < lits.size(); ++iVar) {
+      if (mpz_tstbit(coeffs[iVar].get_mpz_t(), iBit))
+        _buckets.back().push(lits[iVar]);
+    }
+  }
+
+  // coefficients of at least 2^(nb + 1)
+  _buckets.push_back(std::queue<Lit>());
+  _output.push(u);
+  for (int iVar = 0; iVar < lits.size(); ++iVar) {
+    if (mpz_sizeinbase(coeffs[iVar].get_mpz_t(), 2) > nb + 1)
+      _buckets.back().push(lits[iVar]);
+  }
+
+  adderTree(maxsat_formula, pb, _buckets, _output, nb, current_sign, flipped);
+
+  std::vector<uint64_t> kBits;
+  for (size_t i = 0; i < _buckets.size(); i++)
+    kBits.push_back(mpz_tstbit(rhs.get_mpz_t(), i));
+  compare(maxsat_formula, pb, kBits, current_sign);
+}
 
+// Compares the output of the adder tree with the bits of the rhs.
+void VAdder::compare(MaxSATFormula *maxsat_formula, PB *pb,
+                     std::vector<uint64_t> &kBits, pb_Sign current_sign) {
   if (current_sign == _PB_GREATER_OR_EQUAL_ || current_sign == _PB_EQUAL_) {
     greaterThanOrEqual(maxsat_formula, pb, _output, kBits);
   }
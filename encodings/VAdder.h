@@ -55,6 +55,9 @@ protected:
 
   // Encode constraint.
   void encode(PB *pb, MaxSATFormula *maxsat_formula, pb_Sign current_sign);
+  void encodeBig(PB *pb, MaxSATFormula *maxsat_formula, pb_Sign current_sign);
+  void compare(MaxSATFormula *maxsat_formula, PB *pb,
+               std::vector<uint64_t> &kBits, pb_Sign current_sign);
 
   void FA_extra(MaxSATFormula *maxsat_formula, PB *pb, Lit xc, Lit xs, Lit a,
                 Lit b, Lit c);
@@ -42,9 +42,9 @@ struct less_than_wlitt {
 // left...A, right...B
 void VGTE::try_all_values(PB *pb, weightedlitst &left, weightedlitst &right,
                           Lit &z_eq) {
-  int constr_outer_id = 0;
+  int64_t constr_outer_id = 0;
   for (uint left_i = 0; left_i < left.size(); left_i++) {
-    int constr_inner_id = 0;
+    int64_t constr_inner_id = 0;
     for (uint right_i = 0; right_i < right.size(); right_i++) {
       vec<Lit> lits;
       lits.push(z_eq);
@@ -60,27 +60,27 @@ void VGTE::try_all_values(PB *pb, weightedlitst &left, weightedlitst &right,
       if (right_i < right.size() - 1) {
         lits.push(right[right_i + 1].lit);
       }
-      PBPu *pbp_single_try = new PBPu(mx->getIncProofLogId(), lits);
+      PBPu pbp_single_try(mx->getIncProofLogId(), lits);
       mx->addProofExpr(pb, pbp_single_try);
       if (constr_inner_id) {
-        PBPp *pbp_inner = new PBPp(mx->getIncProofLogId());
-        pbp_inner->addition(constr_inner_id, pbp_single_try->_ctrid);
+        PBPp pbp_inner(mx->getProofBuffer(), mx->getIncProofLogId());
+        pbp_inner.addition(constr_inner_id, pbp_single_try._ctrid);
         mx->addProofExpr(pb, pbp_inner);
-        constr_inner_id = pbp_inner->_ctrid;
+        constr_inner_id = pbp_inner._ctrid;
       } else {
-        constr_inner_id = pbp_single_try->_ctrid;
+        constr_inner_id = pbp_single_try._ctrid;
       }
     }
-    PBPp *pbp_outer = new PBPp(mx->getIncProofLogId());
-    pbp_outer->saturation(constr_inner_id);
+    PBPp pbp_outer(mx->getProofBuffer(), mx->getIncProofLogId());
+    pbp_outer.saturation(constr_inner_id);
     if (constr_outer_id) {
-      pbp_outer->addition(constr_outer_id);
+      pbp_outer.addition(constr_outer_id);
     }
     mx->addProofExpr(pb, pbp_outer);
-    constr_outer_id = pbp_outer->_ctrid;
+    constr_outer_id = pbp_outer._ctrid;
   }
-  PBPp *pbp_final = new PBPp(mx->getIncProofLogId());
-  pbp_final->saturation(constr_outer_id);
+  PBPp pbp_final(mx->getProofBuffer(), mx->getIncProofLogId());
+  pbp_final.saturation(constr_outer_id);
   mx->addProofExpr(pb, pbp_final);
 }
 
@@ -101,10 +101,10 @@ weightedlitst VGTE::sort_to_list(wlit_mapt &map) {
   return list;
 }
 
-std::pair<int, int> VGTE::derive_sparse_unary_sum(MaxSATFormula *maxsat_formula,
-                                                  PB *pb, wlit_mapt &left,
-                                                  wlit_mapt &right,
-                                                  wlit_mapt &current) {
+std::pair<int64_t, int64_t>
+VGTE::derive_sparse_unary_sum(MaxSATFormula *maxsat_formula, PB *pb,
+                              wlit_mapt &left, wlit_mapt &right,
+                              wlit_mapt &current) {
   // construct left hand site of the preserving equality
   vec<int64_t> coeffs;
   vec<Lit> lits;
@@ -125,31 +125,29 @@ std::pair<int, int> VGTE::derive_sparse_unary_sum(MaxSATFormula *maxsat_formula,
   }
 
   // log ordering
-  PBPred *p_prev = NULL;
+  PBPred p_prev;
   for (wlit_mapt::iterator current_it = current.begin();
        current_it != current.end(); current_it++) {
-    PB *pb_single_var =
-        new PB(lits, coeffs, current_it->first, _PB_GREATER_OR_EQUAL_);
-    std::pair<PBPred *, PBPred *> p =
-        reify(pb, current_it->second, pb_single_var);
-    if (p_prev != NULL) {
-      assert(p_prev);
+    PB pb_single_var(lits, coeffs, current_it->first, _PB_GREATER_OR_EQUAL_);
+    std::pair<PBPred, PBPred> p =
+        reify(pb, current_it->second, &pb_single_var);
+    if (current_it != current.begin())
       derive_ordering(pb, p_prev, p.first);
-    }
     p_prev = p.second;
   }
 
   // reify constraints to be derived
+  // the first entry of the list is the weight 0 sentinel without a literal
   weight_prev = 0;
-  for (weightedlitst::iterator current_it = current_list.begin();
+  for (weightedlitst::iterator current_it = current_list.begin() + 1;
        current_it != current_list.end(); current_it++) {
     coeffs.push(current_it->weight - weight_prev);
     lits.push(~current_it->lit);
     weight_prev = current_it->weight;
   }
   Lit z_geq = getNewLit(maxsat_formula);
-  PB *pb_full_geq = new PB(lits, coeffs, weight_prev, _PB_GREATER_OR_EQUAL_);
-  std::pair<PBPred *, PBPred *> p_geq = reify(pb, z_geq, pb_full_geq);
+  PB pb_full_geq(lits, coeffs, weight_prev, _PB_GREATER_OR_EQUAL_);
+  std::pair<PBPred, PBPred> p_geq = reify(pb, z_geq, &pb_full_geq);
 
   int64_t sum = 0;
   for (int i = 0; i < lits.size(); i++) {
@@ -157,9 +155,8 @@ std::pair<int, int> VGTE::derive_sparse_unary_sum(MaxSATFormula *maxsat_formula,
     sum += coeffs[i];
   }
   Lit z_leq = getNewLit(maxsat_formula);
-  PB *pb_full_leq =
-      new PB(lits, coeffs, sum - weight_prev, _PB_GREATER_OR_EQUAL_);
-  std::pair<PBPred *, PBPred *> p_leq = reify(pb, z_leq, pb_full_leq);
+  PB pb_full_leq(lits, coeffs, sum - weight_prev, _PB_GREATER_OR_EQUAL_);
+  std::pair<PBPred, PBPred> p_leq = reify(pb, z_leq, &pb_full_leq);
 
   Lit z_eq = getNewLit(maxsat_formula);
   vec<int64_t> coeffs_eq;
@@ -167,8 +164,8 @@ std::pair<int, int> VGTE::derive_sparse_unary_sum(MaxSATFormula *maxsat_formula,
   coeffs_eq.growTo(2, 1);
   lits_eq.push(z_geq);
   lits_eq.push(z_leq);
-  PB *pb_full_eq = new PB(lits_eq, coeffs_eq, 2, _PB_GREATER_OR_EQUAL_);
-  reify(pb, z_eq, pb_full_eq);
+  PB pb_full_eq(lits_eq, coeffs_eq, 2, _PB_GREATER_OR_EQUAL_);
+  reify(pb, z_eq, &pb_full_eq);
 
   try_all_values(pb, left_list, right_list, z_eq);
 
@@ -177,25 +174,25 @@ std::pair<int, int> VGTE::derive_sparse_unary_sum(MaxSATFormula *maxsat_formula,
                      right_list[right_list.size() - 1].weight;
   vec<Lit> lits_geq;
   lits_geq.push(z_geq);
-  PBPu *pbp_rup_geq = new PBPu(mx->getIncProofLogId(), lits_geq);
+  PBPu pbp_rup_geq(mx->getIncProofLogId(), lits_geq);
   mx->addProofExpr(pb, pbp_rup_geq);
-  PBPp *pbp_p_geq = new PBPp(mx->getIncProofLogId());
-  pbp_p_geq->multiplication(pbp_rup_geq->_ctrid, sum_max);
-  pbp_p_geq->addition(p_geq.first->_ctrid);
+  PBPp pbp_p_geq(mx->getProofBuffer(), mx->getIncProofLogId());
+  pbp_p_geq.multiplication(pbp_rup_geq._ctrid, sum_max);
+  pbp_p_geq.addition(p_geq.first._ctrid);
   mx->addProofExpr(pb, pbp_p_geq);
 
   vec<Lit> lits_leq;
   lits_leq.push(z_leq);
-  PBPu *pbp_rup_leq = new PBPu(mx->getIncProofLogId(), lits_leq);
+  PBPu pbp_rup_leq(mx->getIncProofLogId(), lits_leq);
   mx->addProofExpr(pb, pbp_rup_leq);
-  PBPp *pbp_p_leq = new PBPp(mx->getIncProofLogId());
-  pbp_p_leq->multiplication(pbp_rup_leq->_ctrid, sum_max);
-  pbp_p_leq->addition(p_leq.first->_ctrid);
+  PBPp pbp_p_leq(mx->getProofBuffer(), mx->getIncProofLogId());
+  pbp_p_leq.multiplication(pbp_rup_leq._ctrid, sum_max);
+  pbp_p_leq.addition(p_leq.first._ctrid);
   mx->addProofExpr(pb, pbp_p_leq);
 
-  std::pair<int, int> res;
-  res.first = pbp_p_geq->_ctrid;
-  res.second = pbp_p_leq->_ctrid;
+  std::pair<int64_t, int64_t> res;
+  res.first = pbp_p_geq._ctrid;
+  res.second = pbp_p_leq._ctrid;
   return res;
 }
 
@@ -232,7 +229,8 @@ uint64_t VGTE::succ(wlit_mapt &literals, uint64_t weight) {
 // recursive algorithm that actually encodes the PB constraint
 bool VGTE::encodeLeq(uint64_t k, MaxSATFormula *maxsat_formula, PB *pb,
                      const weightedlitst &iliterals, wlit_mapt &oliterals,
-                     pb_Sign current_sign, vec<int> &geq, vec<int> &leq) {
+                     pb_Sign current_sign, vec<int64_t> &geq,
+                     vec<int64_t> &leq) {
   if (iliterals.size() == 0 || k == 0)
     return false;
 
@@ -343,7 +341,7 @@ bool VGTE::encodeLeq(uint64_t k, MaxSATFormula *maxsat_formula, PB *pb,
   }
 
   if (_proof) {
-    std::pair<int, int> res_pair = derive_sparse_unary_sum(
+    std::pair<int64_t, int64_t> res_pair = derive_sparse_unary_sum(
         maxsat_formula, pb, loutputs, routputs, oliterals);
     geq.push(res_pair.first);
     leq.push(res_pair.second);
@@ -375,26 +373,16 @@ bool VGTE::encodeLeq(uint64_t k, MaxSATFormula *maxsat_formula, PB *pb,
   return true;
 }
 
-// copies the current PB constraint into new vectors
+// encodes the terms of the current PB constraint through a view
 void VGTE::encode(PB *pb, MaxSATFormula *maxsat_formula, pb_Sign current_sign) {
-  vec<Lit> lits;
-  uint64_t sum = 0;
-  pb->_lits.copyTo(lits);
-
-  vec<uint64_t> coeffs;
-  for (int i = 0; i < pb->_coeffs.size(); i++) {
-    assert(pb->_coeffs[i] > 0);
-    coeffs.push(pb->_coeffs[i]);
-    sum += pb->_coeffs[i];
-  }
+  TermView lits = pb->view();
+  uint64_t sum = lits.sum();
   uint64_t rhs = pb->_rhs;
 
   // transform the constraint to consider the smallest rhs
   bool flipped = false;
   if (sum - rhs < rhs) {
-    for (int i = 0; i < lits.size(); i++) {
-      lits[i] = ~(lits[i]);
-    }
+    lits = pb->view(true);
     rhs = sum - rhs;
     if (current_sign != _PB_EQUAL_) {
       if (current_sign == _PB_GREATER_OR_EQUAL_)
@@ -405,59 +393,47 @@ void VGTE::encode(PB *pb, MaxSATFormula *maxsat_formula, pb_Sign current_sign) {
     flipped = true;
   }
 
-  encode(maxsat_formula, pb, lits, coeffs, rhs, current_sign, flipped);
+  encode(maxsat_formula, pb, lits, rhs, current_sign, flipped);
 }
 
-void VGTE::encode(MaxSATFormula *maxsat_formula, PB *pb, vec<Lit> &lits,
-                  vec<uint64_t> &coeffs, uint64_t rhs, pb_Sign current_sign,
-                  bool flipped) {
+void VGTE::encode(MaxSATFormula *maxsat_formula, PB *pb, const TermView &lits,
+                  uint64_t rhs, pb_Sign current_sign, bool flipped) {
   if (rhs >= UINT64_MAX) {
     printf("c Overflow in the Encoding\n");
     printf("s UNKNOWN\n");
     exit(_ERROR_);
   }
 
-  vec<Lit> simp_lits;
-  vec<uint64_t> simp_coeffs;
-  lits.copyTo(simp_lits);
-  coeffs.copyTo(simp_coeffs);
-
-  lits.clear();
-  coeffs.clear();
-
   // Fix literals that have a coeff larger than rhs.
-  for (int i = 0; i < simp_lits.size(); i++) {
-    if (simp_coeffs[i] == 0)
+  weightedlitst iliterals;
+  for (int i = 0; i < lits.size(); i++) {
+    uint64_t coeff = lits.coeff(i);
+    if (coeff == 0)
       continue;
 
-    if (simp_coeffs[i] >= UINT64_MAX) {
+    if (coeff >= UINT64_MAX) {
       printf("c Overflow in the Encoding\n");
       printf("s UNKNOWN\n");
       exit(_ERROR_);
     }
 
-    if (simp_coeffs[i] > (unsigned)rhs && current_sign == _PB_LESS_OR_EQUAL_) {
-      addUnitClause(maxsat_formula, pb, ~simp_lits[i]);
+    if (coeff > (unsigned)rhs && current_sign == _PB_LESS_OR_EQUAL_) {
+      addUnitClause(maxsat_formula, pb, ~lits[i]);
     } else {
-      lits.push(simp_lits[i]);
-      coeffs.push(simp_coeffs[i]);
+      wlitt wl;
+      wl.lit = lits[i];
+      wl.weight = coeff;
+      iliterals.push_back(wl);
     }
   }
 
-  if (lits.size() == 0)
+  if (iliterals.size() == 0)
     return;
 
-  weightedlitst iliterals;
-  for (int i = 0; i < lits.size(); i++) {
-    wlitt wl;
-    wl.lit = lits[i];
-    wl.weight = coeffs[i];
-    iliterals.push_back(wl);
-  }
   less_than_wlitt lt_wlit;
   std::sort(iliterals.begin(), iliterals.end(), lt_wlit);
-  vec<int> geq;
-  vec<int> leq;
+  vec<int64_t> geq;
+  vec<int64_t> leq;
   if (current_sign == _PB_GREATER_OR_EQUAL_) {
     encodeLeq(rhs, maxsat_formula, pb, iliterals, pb_oliterals, current_sign,
               geq, leq);
@@ -469,28 +445,28 @@ void VGTE::encode(MaxSATFormula *maxsat_formula, PB *pb, vec<Lit> &lits,
   if (_proof) {
     if (current_sign == _PB_LESS_OR_EQUAL_ || current_sign == _PB_EQUAL_) {
       if (geq.size() != 0) {
-        PBPp *pbp_output_leq = new PBPp(mx->getIncProofLogId());
+        PBPp pbp_output_leq(mx->getProofBuffer(), mx->getIncProofLogId());
         if (current_sign == _PB_EQUAL_ && !flipped) {
-          pbp_output_leq->addition(pb->_id + 1, geq[0]);
+          pbp_output_leq.addition(pb->_id + 1, geq[0]);
         } else {
-          pbp_output_leq->addition(pb->_id, geq[0]);
+          pbp_output_leq.addition(pb->_id, geq[0]);
         }
         for (int i = 1; i < geq.size(); i++) {
-          pbp_output_leq->addition(geq[i]);
+          pbp_output_leq.addition(geq[i]);
         }
         mx->addProofExpr(pb, pbp_output_leq);
       }
     }
     if (current_sign == _PB_GREATER_OR_EQUAL_ || current_sign == _PB_EQUAL_) {
       if (leq.size() != 0) {
-        PBPp *pbp_output_geq = new PBPp(mx->getIncProofLogId());
+        PBPp pbp_output_geq(mx->getProofBuffer(), mx->getIncProofLogId());
         if (current_sign == _PB_EQUAL_ && flipped) {
-          pbp_output_geq->addition(pb->_id + 1, leq[0]);
+          pbp_output_geq.addition(pb->_id + 1, leq[0]);
         } else {
-          pbp_output_geq->addition(pb->_id, leq[0]);
+          pbp_output_geq.addition(pb->_id, leq[0]);
         }
         for (int i = 1; i < leq.size(); i++) {
-          pbp_output_geq->addition(leq[i]);
+          pbp_output_geq.addition(leq[i]);
         }
         mx->addProofExpr(pb, pbp_output_geq);
       }
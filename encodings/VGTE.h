@@ -53,13 +53,13 @@ protected:
   bool _proof;
 
   void encode(PB *pb, MaxSATFormula *maxsat_formula, pb_Sign current_sign);
-  void encode(MaxSATFormula *maxsat_formula, PB *pb, vec<Lit> &lits,
-              vec<uint64_t> &coeffs, uint64_t rhs, pb_Sign current_sign,
-              bool flipped);
+  void encode(MaxSATFormula *maxsat_formula, PB *pb, const TermView &lits,
+              uint64_t rhs, pb_Sign current_sign, bool flipped);
 
   bool encodeLeq(uint64_t k, MaxSATFormula *maxsat_formula, PB *pb,
                  const weightedlitst &iliterals, wlit_mapt &oliterals,
-                 pb_Sign current_sign, vec<int> &geq, vec<int> &leq);
+                 pb_Sign current_sign, vec<int64_t> &geq,
+                 vec<int64_t> &leq);
   Lit getNewLit(MaxSATFormula *maxsat_formula);
   Lit get_var(MaxSATFormula *maxsat_formula, wlit_mapt &oliterals,
               uint64_t weight);
@@ -74,10 +74,10 @@ protected:
   vec<uint64_t> unit_coeffs;
 
   // proof logging (left...A, right...B, current...E)
-  std::pair<int, int> derive_sparse_unary_sum(MaxSATFormula *maxsat_formula,
-                                              PB *pb, wlit_mapt &left,
-                                              wlit_mapt &right,
-                                              wlit_mapt &current);
+  std::pair<int64_t, int64_t>
+  derive_sparse_unary_sum(MaxSATFormula *maxsat_formula, PB *pb,
+                          wlit_mapt &left, wlit_mapt &right,
+                          wlit_mapt &current);
   weightedlitst sort_to_list(wlit_mapt &map);
   void try_all_values(PB *pb, weightedlitst &left, weightedlitst &right,
                       Lit &z_eq);
@@ -32,9 +32,8 @@ using namespace openwbo;
 
 void VSequential::encode(Card *card, MaxSATFormula *maxsat_formula,
                          pb_Sign sign) {
-  vec<Lit> lits;
   uint64_t rhs = card->_rhs;
-  card->_lits.copyTo(lits);
+  TermView lits = card->view();
   int n = lits.size();
 
   // >= we need to fix output @rhs with positive literal
@@ -46,12 +45,8 @@ void VSequential::encode(Card *card, MaxSATFormula *maxsat_formula,
   // transform the constraint to consider the smallest rhs
   bool flipped = false;
   if (n - rhs < rhs) {
-    int s = 0;
-    for (int i = 0; i < lits.size(); i++) {
-      s += 1;
-      lits[i] = ~(lits[i]);
-    }
-    rhs = s - rhs;
+    lits = card->view(true);
+    rhs = n - rhs;
     if (current_sign != _PB_EQUAL_) {
       if (current_sign == _PB_GREATER_OR_EQUAL_)
         current_sign = _PB_LESS_OR_EQUAL_;
@@ -83,8 +78,8 @@ void VSequential::encode(Card *card, MaxSATFormula *maxsat_formula,
 
   if (_proof){
     // pbp logging
-    vec<int> leq;
-    vec<int> geq;
+    vec<int64_t> leq;
+    vec<int64_t> geq;
 
     for (int i = 1; i <= n; i++) {
       int m = i;
@@ -101,34 +96,34 @@ void VSequential::encode(Card *card, MaxSATFormula *maxsat_formula,
         }
       }
       assert(left.size() == right.size());
-      std::pair<int, int> res = derive_unary_sum(card, left, right);
+      std::pair<int64_t, int64_t> res = derive_unary_sum(card, left, right);
       geq.push(res.first);
       leq.push(res.second);
     }
 
     if (current_sign == _PB_GREATER_OR_EQUAL_ || current_sign == _PB_EQUAL_) {
-      PBPp *pbp = new PBPp(mx->getIncProofLogId());
+      PBPp pbp(mx->getProofBuffer(), mx->getIncProofLogId());
       if (current_sign == _PB_EQUAL_ && flipped) {
-        pbp->addition(card->_id + 1, leq[0]);
+        pbp.addition(card->_id + 1, leq[0]);
       } else {
-        pbp->addition(card->_id, leq[0]);
+        pbp.addition(card->_id, leq[0]);
       }
       for (int i = 1; i < leq.size(); i++) {
-        pbp->addition(leq[i]);
+        pbp.addition(leq[i]);
       }
       mx->addProofExpr(card, pbp);
     }
 
 
     if (current_sign == _PB_LESS_OR_EQUAL_ || current_sign == _PB_EQUAL_) {
-      PBPp *pbp = new PBPp(mx->getIncProofLogId());
+      PBPp pbp(mx->getProofBuffer(), mx->getIncProofLogId());
       if (current_sign == _PB_EQUAL_ && !flipped) {
-        pbp->addition(card->_id + 1, geq[0]);
+        pbp.addition(card->_id + 1, geq[0]);
       } else {
-        pbp->addition(card->_id, leq[0]);
+        pbp.addition(card->_id, leq[0]);
       }
       for (int i = 1; i < geq.size(); i++) {
-        pbp->addition(geq[i]);
+        pbp.addition(geq[i]);
       }
       mx->addProofExpr(card, pbp);
     }
@@ -65,8 +65,8 @@ void VTotalizer::adder(MaxSATFormula *maxsat_formula, Card *card,
 }
 
 void VTotalizer::toCNF(MaxSATFormula *maxsat_formula, Card *card,
-                       vec<Lit> &lits_out, int64_t k, vec<int> &geq,
-                       vec<int> &leq) {
+                       vec<Lit> &lits_out, int64_t k, vec<int64_t> &geq,
+                       vec<int64_t> &leq) {
   vec<Lit> left;
   vec<Lit> right;
 
@@ -114,7 +114,8 @@ void VTotalizer::toCNF(MaxSATFormula *maxsat_formula, Card *card,
       lits_in.push(right[i]);
     }
     assert(lits_in.size() == lits_out.size());
-    std::pair<int, int> res_pair = derive_unary_sum(card, lits_in, lits_out);
+    std::pair<int64_t, int64_t> res_pair =
+        derive_unary_sum(card, lits_in, lits_out);
     geq.push(res_pair.first);
     leq.push(res_pair.second);
   }
@@ -125,29 +126,21 @@ void VTotalizer::toCNF(MaxSATFormula *maxsat_formula, Card *card,
 
 void VTotalizer::encode(Card *card, MaxSATFormula *maxsat_formula,
                         pb_Sign sign) {
-  vec<Lit> lits;
-  vec<Lit> pb_outlits;
-  vec<int64_t> coeffs;
   cardinality_outlits.clear();
   cardinality_inlits.clear();
-  card->_lits.copyTo(lits);
+  TermView lits = card->view();
   int n = lits.size();
   _rhs = card->_rhs;
 
   // code adapted from Open-WBO
   // would also support PB constraints using the sequential encoding
-  coeffs.growTo(lits.size(), 1);
   pb_Sign current_sign = sign;
 
   // transform the constraint to consider the smallest rhs
   bool flipped = false;
   if (n - _rhs < _rhs) {
-    int s = 0;
-    for (int i = 0; i < lits.size(); i++) {
-      s += 1;
-      lits[i] = ~(lits[i]);
-    }
-    _rhs = s - _rhs;
+    lits = card->view(true);
+    _rhs = n - _rhs;
     if (current_sign != _PB_EQUAL_) {
       if (current_sign == _PB_GREATER_OR_EQUAL_)
         current_sign = _PB_LESS_OR_EQUAL_;
@@ -168,10 +161,11 @@ void VTotalizer::encode(Card *card, MaxSATFormula *maxsat_formula,
     cardinality_outlits.push(p);
   }
 
-  lits.copyTo(cardinality_inlits);
+  for (int i = 0; i < lits.size(); i++)
+    cardinality_inlits.push(lits[i]);
 
-  vec<int> geq;
-  vec<int> leq;
+  vec<int64_t> geq;
+  vec<int64_t> leq;
   toCNF(maxsat_formula, card, cardinality_outlits, k, geq, leq);
   assert(cardinality_inlits.size() == 0);
 
@@ -185,26 +179,26 @@ void VTotalizer::encode(Card *card, MaxSATFormula *maxsat_formula,
   // proof log fixing output
   if (_proof) {
     if (current_sign == _PB_GREATER_OR_EQUAL_ || current_sign == _PB_EQUAL_) {
-      PBPp *pbp = new PBPp(mx->getIncProofLogId());
+      PBPp pbp(mx->getProofBuffer(), mx->getIncProofLogId());
       if (current_sign == _PB_EQUAL_ && flipped) {
-        pbp->addition(card->_id + 1, leq[0]);
+        pbp.addition(card->_id + 1, leq[0]);
       } else {
-        pbp->addition(card->_id, leq[0]);
+        pbp.addition(card->_id, leq[0]);
       }
       for (int i = 1; i < leq.size(); i++) {
-        pbp->addition(leq[i]);
+        pbp.addition(leq[i]);
       }
       mx->addProofExpr(card, pbp);
     }
     if (current_sign == _PB_LESS_OR_EQUAL_ || current_sign == _PB_EQUAL_) {
-      PBPp *pbp = new PBPp(mx->getIncProofLogId());
+      PBPp pbp(mx->getProofBuffer(), mx->getIncProofLogId());
       if (current_sign == _PB_EQUAL_ && !flipped) {
-        pbp->addition(card->_id + 1, geq[0]);
+        pbp.addition(card->_id + 1, geq[0]);
       } else {
-        pbp->addition(card->_id, geq[0]);
+        pbp.addition(card->_id, geq[0]);
       }
       for (int i = 1; i < geq.size(); i++) {
-        pbp->addition(geq[i]);
+        pbp.addition(geq[i]);
       }
       mx->addProofExpr(card, pbp);
     }
@@ -51,7 +51,7 @@ private:
   void adder(MaxSATFormula *maxsat_formula, Card *card, vec<Lit> &left,
              vec<Lit> &right, vec<Lit> &output);
   void toCNF(MaxSATFormula *maxsat_formula, Card *card, vec<Lit> &lits,
-             int64_t k, vec<int> &geq, vec<int> &leq);
+             int64_t k, vec<int64_t> &geq, vec<int64_t> &leq);
   int _rhs;
   vec<Lit> cardinality_inlits; // Stores the inputs of the cardinality
                                // constraint encoding for the totalizer encoding
@@ -0,0 +1,44 @@
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+# Counts the heap allocations of VeritasPBLib while it parses and encodes a
+# scaling.py instance and writes the CNF and the proof. Several binaries can
+# be given to compare them on the same instance.
+
+if len(sys.argv) < 2:
+        print("Usage: python3 alloc_benchmark.py <N> [VeritasPBLib binary ...]")
+        exit()
+
+here = os.path.dirname(os.path.abspath(__file__))
+n = sys.argv[1]
+binaries = sys.argv[2:] if len(sys.argv) > 2 else [
+        os.path.join(here, "..", "VeritasPBLib")]
+
+counter = os.path.join(here, "malloc_count.so")
+if not os.path.exists(counter):
+        subprocess.run(["cc", "-O2", "-shared", "-fPIC", "-o", counter,
+                        os.path.join(here, "malloc_count.c")], check=True)
+
+with tempfile.TemporaryDirectory() as tmp:
+        instance = os.path.join(tmp, "scaling" + n + ".opb")
+        with open(instance, "w") as f:
+                subprocess.run([sys.executable, os.path.join(here, "scaling.py"), n],
+                               stdout=f, check=True)
+
+        # the CNF and the proof are written next to the instance, so every
+        # binary runs without output options
+        for binary in binaries:
+                env = dict(os.environ, LD_PRELOAD=counter)
+                result = subprocess.run([binary, instance],
+                                        stdout=subprocess.DEVNULL, stderr=subprocess.PIPE,
+                                        encoding="utf-8", env=env)
+                if result.returncode != 0:
+                        print("Error: %s exited with %d" % (binary, result.returncode))
+                        exit(1)
+                print("c " + binary)
+                for line in result.stderr.split("\n"):
+                        if re.match(r"c (Allocations|Reallocations|Frees|Allocated bytes):", line):
+                                print(line)
@@ -0,0 +1,52 @@
+/*
+ * Counts the heap allocations of a program. Build it as a shared library and
+ * preload it:
+ *
+ *   cc -O2 -shared -fPIC -o malloc_count.so malloc_count.c
+ *   LD_PRELOAD=./malloc_count.so VeritasPBLib ...
+ *
+ * The counts are written to stderr when the program exits. Only works with
+ * glibc, whose allocator is reached through the __libc_* entry points.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+static unsigned long long nb_malloc, nb_realloc, nb_free, bytes;
+
+void *malloc(size_t size) {
+  __atomic_fetch_add(&nb_malloc, 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&bytes, size, __ATOMIC_RELAXED);
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size) {
+  __atomic_fetch_add(&nb_malloc, 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&bytes, n * size, __ATOMIC_RELAXED);
+  return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+  __atomic_fetch_add(ptr == NULL ? &nb_malloc : &nb_realloc, 1,
+                     __ATOMIC_RELAXED);
+  __atomic_fetch_add(&bytes, size, __ATOMIC_RELAXED);
+  return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr) {
+  if (ptr != NULL)
+    __atomic_fetch_add(&nb_free, 1, __ATOMIC_RELAXED);
+  __libc_free(ptr);
+}
+
+__attribute__((destructor)) static void report(void) {
+  fprintf(stderr, "c Allocations: %llu\n", nb_malloc);
+  fprintf(stderr, "c Reallocations: %llu\n", nb_realloc);
+  fprintf(stderr, "c Frees: %llu\n", nb_free);
+  fprintf(stderr, "c Allocated bytes: %llu\n", bytes);
+}
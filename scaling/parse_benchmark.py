@@ -0,0 +1,52 @@
+import os
+import random
+import re
+import subprocess
+import sys
+import time
+
+# Measures the OPB parsing throughput of VeritasPBLib in MB/s.
+# The instance is only parsed (-stats), no encoding is written.
+
+if len(sys.argv) < 2:
+        print("Usage: python3 parse_benchmark.py <MB> [VeritasPBLib binary] [parse threads]")
+        exit()
+
+size = int(sys.argv[1]) * 1000 * 1000
+binary = sys.argv[2] if len(sys.argv) > 2 else os.path.join(
+        os.path.dirname(os.path.abspath(__file__)), "..", "VeritasPBLib")
+threads = sys.argv[3] if len(sys.argv) > 3 else "1"
+filename = "parse_benchmark_" + sys.argv[1] + "MB.opb"
+
+if not os.path.exists(filename):
+        random.seed(42)
+        nb_variables = 100000
+        with open(filename, "w") as f:
+                f.write("* #variable= " + str(nb_variables) + " #constraint= 0\n")
+                written = 0
+                while written < size:
+                        n = random.randint(10, 50)
+                        xs = random.sample(range(1, nb_variables + 1), n)
+                        if random.random() < 0.5:
+                                coeffs = [1] * n
+                        else:
+                                coeffs = [random.randint(1, 1000000) for i in range(n)]
+                        # keep the constraints non-trivial
+                        rhs = sum(coeffs) // 2
+                        s = " ".join("+" + str(c) + " x" + str(x) for c, x in zip(coeffs, xs))
+                        s = s + " >= " + str(rhs) + " ;\n"
+                        f.write(s)
+                        written += len(s)
+
+mb = os.path.getsize(filename) / (1000.0 * 1000.0)
+start = time.time()
+result = subprocess.run([binary, "-stats", "-parse-threads=" + threads, filename],
+                        stdout=subprocess.PIPE, encoding="utf-8")
+wall = time.time() - start
+
+for line in result.stdout.split("\n"):
+        m = re.search(r"Parse (time|throughput):\s+([0-9.]+ \S+)", line)
+        if m:
+                print("c Parse " + m.group(1) + ": " + m.group(2))
+print("c File size: %.2f MB" % mb)
+print("c Wall clock (parse + stats): %.2f s, %.2f MB/s" % (wall, mb / wall))
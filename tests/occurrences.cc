@@ -0,0 +1,112 @@
+/*!
+ * Checks that the occurrence index of a formula picks up the clauses that the
+ * encoders append after it was first built. getOccurrences only refreshes the
+ * index when it is called, so after each encoding it has to match an index
+ * that is built from scratch. Compiled and run by test_occurrences.py.
+ */
+
+#include "MaxSATFormula.h"
+#include "encodings/Encodings.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+using namespace openwbo;
+
+static void check(MaxSATFormula &mx, const char *step) {
+  const OccurrenceIndex &index = mx.getOccurrences();
+  OccurrenceIndex fresh;
+  fresh.update(mx);
+
+  if (index.nLits() != 2 * mx.nVars() || fresh.nLits() != index.nLits()) {
+    printf("c %s: %d literals indexed, %d expected\n", step, index.nLits(),
+           2 * mx.nVars());
+    exit(1);
+  }
+  int64_t occs = 0;
+  for (int l = 0; l < index.nLits(); l++) {
+    OccurrenceIndex::Slice a = index.occurrences(NSPACE::toLit(l));
+    OccurrenceIndex::Slice b = fresh.occurrences(NSPACE::toLit(l));
+    if (a.size() != b.size()) {
+      printf("c %s: literal %d has %lld occurrences, %lld expected\n", step, l,
+             (long long)a.size(), (long long)b.size());
+      exit(1);
+    }
+    // the hard clauses of an encoding come after the constraints that were
+    // indexed before it, so only the sets of occurrences are the same
+    std::vector<std::pair<int, int64_t> > x, y;
+    for (int64_t i = 0; i < a.size(); i++) {
+      x.push_back(std::make_pair(a[i].kind, a[i].index));
+      y.push_back(std::make_pair(b[i].kind, b[i].index));
+    }
+    std::sort(x.begin(), x.end());
+    std::sort(y.begin(), y.end());
+    if (x != y) {
+      printf("c %s: the occurrences of literal %d differ\n", step, l);
+      exit(1);
+    }
+    occs += a.size();
+  }
+  printf("c %s: %lld hard clauses, %lld occurrences\n", step,
+         (long long)mx.nHard(), (long long)occs);
+}
+
+int main() {
+  MaxSATFormula mx;
+  mx.setFormat(_FORMAT_PB_);
+  mx.setProblemType(_UNWEIGHTED_);
+  for (int v = 0; v < 12; v++)
+    mx.newVar();
+
+  // x1 + x2 + x3 >= 1 is a hard clause
+  vec<Lit> lits;
+  vec<int64_t> coeffs;
+  for (int v = 0; v < 3; v++) {
+    lits.push(mkLit(v));
+    coeffs.push(1);
+  }
+  mx.addPBConstraint(new PB(lits, coeffs, 1, _PB_GREATER_OR_EQUAL_));
+
+  // x5 + ... + x12 <= 3 is a cardinality constraint
+  lits.clear();
+  coeffs.clear();
+  for (int v = 4; v < 12; v++) {
+    lits.push(mkLit(v));
+    coeffs.push(1);
+  }
+  mx.addPBConstraint(new PB(lits, coeffs, 3, _PB_LESS_OR_EQUAL_));
+
+  // 3 x1 + 2 x5 + 5 x6 + 4 x9 >= 6 stays a PB constraint
+  lits.clear();
+  coeffs.clear();
+  int vars[] = {0, 4, 5, 8}, weights[] = {3, 2, 5, 4};
+  for (int i = 0; i < 4; i++) {
+    lits.push(mkLit(vars[i]));
+    coeffs.push(weights[i]);
+  }
+  mx.addPBConstraint(new PB(lits, coeffs, 6, _PB_GREATER_OR_EQUAL_));
+
+  if (mx.nHard() != 1 || mx.nCard() != 1 || mx.nPB() != 1) {
+    printf("c expected a clause, a cardinality and a PB constraint\n");
+    return 1;
+  }
+
+  // the first update indexes the input, the encodings then add clauses and
+  // variables that the next calls have to merge in
+  check(mx, "input");
+  int64_t hard = mx.nHard();
+
+  Encodings encoder(_CARD_TOTALIZER_, _PB_ADDER_);
+  encoder.encode(mx.getCardinalityConstraint(0), &mx, false);
+  check(mx, "cardinality");
+  encoder.encode(mx.getPBConstraint(0), &mx, false);
+  check(mx, "pb");
+
+  if (mx.nHard() == hard) {
+    printf("c the encodings did not add clauses\n");
+    return 1;
+  }
+  return 0;
+}
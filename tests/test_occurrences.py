@@ -0,0 +1,35 @@
+import subprocess
+import unittest
+from pathlib import Path
+
+# Builds occurrences.cc with the sources of the encoder and runs it. It checks
+# that the occurrence index picks up the clauses of the encodings, which the
+# command line only indexes before encoding (-stats).
+
+root = Path("..")
+minisat = root / "solvers" / "minisat2.2"
+generated = Path("generated")
+
+
+class TestOccurrences(unittest.TestCase):
+
+    def test_update_after_encoding(self):
+        sources = [path for path in sorted(root.glob("*.cc"))
+                   if path.name != "Main.cc"]
+        sources += sorted((root / "encodings").glob("*.cc"))
+        sources += [minisat / "core" / "Solver.cc",
+                    minisat / "utils" / "System.cc",
+                    minisat / "utils" / "Options.cc"]
+        binary = generated / "occurrences"
+        subprocess.run(["g++", "-std=c++11", "-pthread", "-DNSPACE=Minisat",
+                        "-D__STDC_LIMIT_MACROS", "-D__STDC_FORMAT_MACROS",
+                        "-I" + str(root), "-I" + str(minisat), "-o",
+                        str(binary), "occurrences.cc"] + [str(s) for s in sources]
+                       + ["-lz", "-lgmpxx", "-lgmp"], check=True)
+        result = subprocess.run([str(binary)], stdout=subprocess.PIPE,
+                                encoding="utf-8")
+        self.assertEqual(result.returncode, 0, result.stdout)
+
+
+if __name__ == '__main__':
+    unittest.main()
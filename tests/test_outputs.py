@@ -0,0 +1,257 @@
+from settings import vertiaspblib
+import gzip
+import re
+import struct
+import subprocess
+import unittest
+from pathlib import Path
+
+# Regression tests of the output files. Each test encodes an instance of
+# instances/ and compares the written files with the files in expected/.
+# They only need the encoder: the proofs are not checked with VeriPB, but
+# every redundance step is checked to define its witness variable.
+
+instances = Path("instances")
+expected = Path("expected")
+generated = Path("generated")
+
+# option that names the output file of each extension
+output_options = {".cnf": "-cnf=", ".wcnf": "-cnf=", ".pbp": "-pbp=",
+                  ".opb": "-opb="}
+
+
+def run_encoder(args):
+    return subprocess.run([vertiaspblib] + args, stdout=subprocess.PIPE,
+                          stderr=subprocess.STDOUT, encoding="utf-8")
+
+
+def read_output(path):
+    if path.suffix == ".gz":
+        with gzip.open(path, "rt") as file:
+            return file.read()
+    if path.suffix == ".zst":
+        return subprocess.run(["zstd", "-dc", str(path)], check=True,
+                              stdout=subprocess.PIPE, encoding="utf-8").stdout
+    return path.read_text()
+
+
+class TestOutputs(unittest.TestCase):
+
+    def encode(self, name, instance, args=[], outputs=[".cnf", ".pbp"],
+               suffix=""):
+        """Encodes instances/<instance> and compares each output with
+        expected/<name><ext>. The outputs are written to generated/ with
+        'suffix' appended to their names."""
+        command = list(args)
+        written = {}
+        for ext in outputs:
+            written[ext] = generated / (name + ext + suffix)
+            if written[ext].exists():
+                written[ext].unlink()
+            command.append(output_options[ext] + str(written[ext]))
+        command.append(str(instances / instance))
+
+        result = run_encoder(command)
+        self.assertEqual(result.returncode, 0, result.stdout)
+        for ext, path in written.items():
+            text = read_output(path)
+            self.assertEqual(text, (expected / (name + ext)).read_text(),
+                             "%s differs from the expected output" % path)
+            if ext == ".pbp":
+                self.checkWitnesses(text)
+        return result.stdout
+
+    def fails(self, args, message):
+        """Runs the encoder and checks that it stops with the error."""
+        result = run_encoder(args)
+        self.assertNotEqual(result.returncode, 0, result.stdout)
+        self.assertIn("c Error: " + message, result.stdout)
+
+    def checkWitnesses(self, proof):
+        """The witness of each redundance step reifies a literal of its
+        constraint, so it has to name a variable of the constraint."""
+        for line in proof.splitlines():
+            if line.startswith("red "):
+                constraint, witness = line[4:].split(";")
+                variable = witness.split("->")[0].strip()
+                self.assertIn(variable, re.findall(r"x\d+", constraint), line)
+
+    def test_gap_in_names(self):
+        # x3 and x4 are not used, the auxiliary variables start at x6
+        self.encode("gap", "gap.opb", ["-card=1"])
+        self.encode("gap_sequential", "gap.opb", ["-card=0"])
+
+    def test_big_coefficients(self):
+        # 2^64 stays above 64 bits after clamping, so the first constraint is
+        # encoded by the adder with GMP whichever encoding -pb selects; the
+        # second one is clamped to a clause
+        self.encode("big", "big.opb")
+        self.encode("big", "big.opb", ["-pb=0"], suffix=".gte")
+        proof = (generated / "big.pbp").read_text()
+        self.assertIn("18446744073709551616", proof)
+
+    def test_gcd(self):
+        # the proof divides each input constraint by the gcd before it is
+        # used: >= (id 1), <= (id 2) and both halves of the equalities
+        self.encode("gcd", "gcd.opb")
+        proof = (generated / "gcd.pbp").read_text().splitlines()
+        for step in ["p 1 2 d", "p 2 2 d", "p 3 3 d", "p 4 3 d", "p 5 2 d",
+                     "p 6 2 d"]:
+            self.assertIn(step, proof)
+
+    def test_dedup(self):
+        # the repeated clauses are neither written to the CNF nor derived in
+        # the proof; the first occurrences are written with sorted literals
+        output = self.encode("dup", "dup.opb", ["-dedup"])
+        self.assertIn("Duplicate clauses dropped: 2", output)
+        cnf = (generated / "dup.cnf").read_text().splitlines()
+        self.assertEqual(cnf[0], "p cnf 9 21")
+        self.assertIn("-1 -3 0", cnf)
+        self.assertNotIn("-3 -1 0", cnf)
+
+    def test_products(self):
+        # the product variables are numbered after #variable=, the proof
+        # refers to the linear formula with the linearized objective
+        self.encode("product", "product.opb", ["-card=1"],
+                    [".cnf", ".pbp", ".opb"])
+
+    def test_wcnf_ub(self):
+        # the soft clauses are units, so their literals are the relaxation
+        # variables; -ub bounds their weighted sum, which is encoded with the
+        # hard clauses and written to the PB formula with the objective
+        self.encode("maxsat_ub", "maxsat.wcnf", ["-ub=5"],
+                    [".cnf", ".pbp", ".opb"])
+        opb = (generated / "maxsat_ub.opb").read_text()
+        self.assertIn("min: +3 x1 +2 x2 +4 x3 ;", opb)
+        self.assertIn("+3 x1 +2 x2 +4 x3 <= 5 ;", opb)
+
+    def test_wbo(self):
+        # b = x6 satisfies the <= soft constraint with coefficient -3, and the
+        # cost of the relaxation variables is the objective
+        self.encode("soft", "soft.wbo", ["-card=1"], [".wcnf", ".pbp", ".opb"])
+        opb = (generated / "soft.opb").read_text()
+        self.assertIn("min: +3 x6 +2 x7 ;", opb)
+        self.assertIn("+1 x1 +1 x2 +1 x3 -3 x6 <= 0 ;", opb)
+        # the top cost 10 bounds the cost by 9, which -ub lowers
+        self.assertIn("+3 x6 +2 x7 <= 9 ;", opb)
+        self.encode("soft_ub", "soft.wbo", ["-card=1", "-ub=4"],
+                    [".wcnf", ".pbp", ".opb"])
+        opb = (generated / "soft_ub.opb").read_text()
+        self.assertIn("+3 x6 +2 x7 <= 4 ;", opb)
+        # the OPB file is compressed like the WCNF and the proof
+        self.encode("soft", "soft.wbo", ["-card=1", "-compress=gz"],
+                    [".wcnf", ".pbp", ".opb"], ".gz")
+
+    def test_snapshot(self):
+        # a loaded snapshot is encoded like the parsed instance, including the
+        # coefficients above 64 bits and the gcd divisions of the proof
+        for name in ["big", "gcd"]:
+            snapshot = generated / (name + ".snap")
+            self.encode(name, name + ".opb",
+                        ["-save-snapshot=" + str(snapshot)])
+            self.encode(name, name + ".opb",
+                        ["-load-snapshot=" + str(snapshot)], suffix=".loaded")
+
+    def test_compress(self):
+        # the compressed files hold the expected outputs, also when they are
+        # compressed on a separate thread
+        self.encode("gcd", "gcd.opb", ["-compress=gz"], suffix=".gz")
+        self.encode("gcd", "gcd.opb", ["-compress=gz", "-compress-thread"],
+                    suffix=".thread.gz")
+        # the default names get the extension of the compression
+        instance = generated / "compressed.opb"
+        instance.write_text((instances / "gcd.opb").read_text())
+        result = run_encoder(["-compress=gz", str(instance)])
+        self.assertEqual(result.returncode, 0, result.stdout)
+        for ext in [".cnf", ".pbp"]:
+            self.assertEqual(read_output(generated / ("compressed" + ext +
+                                                      ".gz")),
+                             (expected / ("gcd" + ext)).read_text())
+
+        result = run_encoder(["-compress=zstd", "-cnf=" +
+                              str(generated / "gcd.cnf.zst"),
+                              str(instances / "gcd.opb")])
+        if "cannot write zstd" in result.stdout:
+            self.skipTest("zstd is not compiled in")
+        self.encode("gcd", "gcd.opb", ["-compress=zstd"], suffix=".zst")
+        self.encode("gcd", "gcd.opb", ["-compress=zstd", "-compress-thread"],
+                    suffix=".thread.zst")
+
+    def test_corrupt_snapshot(self):
+        # names that are not xN are hashed, so the snapshot has a pool and
+        # slots; they are only allowed without a proof
+        snapshot = generated / "names.snap"
+        self.encode("names", "names.opb",
+                    ["-no-proof", "-save-snapshot=" + str(snapshot)], [".cnf"])
+        self.encode("names", "names.opb",
+                    ["-no-proof", "-load-snapshot=" + str(snapshot)], [".cnf"],
+                    ".loaded")
+        data = snapshot.read_bytes()
+        pool, slots = snapshot_names(data)
+        load = ["-no-proof", "-cnf=" + str(generated / "bad.cnf"),
+                "-load-snapshot=" + str(generated / "bad.snap")]
+
+        # a slot with a variable that does not exist
+        bad = bytearray(data)
+        used = [i for i in range(slots[0], slots[1], 4)
+                if struct.unpack_from("=i", bad, i)[0] >= 0]
+        struct.pack_into("=i", bad, used[0], 1000000)
+        (generated / "bad.snap").write_bytes(bad)
+        self.fails(load, "Corrupted snapshot file")
+
+        # a pool that is not null terminated
+        bad = bytearray(data)
+        bad[pool[1] - 1] = ord("x")
+        (generated / "bad.snap").write_bytes(bad)
+        self.fails(load, "Corrupted snapshot file")
+
+        # a table whose size is not a power of two
+        bad = bytearray(data)
+        struct.pack_into("=q", bad, header_offset("nSlots"),
+                         (slots[1] - slots[0]) // 4 - 1)
+        (generated / "bad.snap").write_bytes(bad)
+        self.fails(load, "Corrupted snapshot file")
+
+        (generated / "bad.snap").write_bytes(data[:len(data) // 2])
+        self.fails(load, "Truncated snapshot file")
+
+
+# Header of a snapshot (Snapshot.h) and the arrays in front of the constraints,
+# with their element sizes, each padded to 8 bytes.
+snapshot_header = [("magic", "8s"), ("version", "I"), ("byteOrder", "I"),
+                   ("nVars", "i"), ("format", "i"), ("problemType", "i"),
+                   ("hasProducts", "i"), ("proofLogId", "q"),
+                   ("hardWeight", "Q"), ("sumSoftWeight", "Q"),
+                   ("maxSoftWeight", "Q"), ("nHard", "q"), ("nHardLits", "q"),
+                   ("nInputClauses", "q"), ("nSoft", "q"), ("nSoftLits", "q"),
+                   ("nVarMap", "q"), ("nIndexToVar", "q"), ("nRef", "q"),
+                   ("nPool", "q"), ("nSlots", "q"), ("nNames", "i"),
+                   ("nArbitrary", "i"), ("nCard", "q"), ("nCardLits", "q"),
+                   ("nPB", "q"), ("nPBLits", "q"), ("nBigChars", "q")]
+snapshot_arrays = [("nHard", 8), ("nHardLits", 4), ("nSoft", 8),
+                   ("nSoftLits", 4), ("nSoft", 8), ("nSoft", 4),
+                   ("nVarMap", 8), ("nIndexToVar", 4), ("nRef", 8),
+                   ("nPool", 1), ("nSlots", 4)]
+
+
+def header_offset(field):
+    names = [name for name, _ in snapshot_header]
+    formats = [f for _, f in snapshot_header]
+    return struct.calcsize("=" + "".join(formats[:names.index(field)]))
+
+
+def snapshot_names(data):
+    """Returns the [begin, end) byte ranges of the pool and the slots."""
+    fields = struct.unpack_from("=" + "".join(f for _, f in snapshot_header),
+                                data)
+    header = dict(zip([name for name, _ in snapshot_header], fields))
+    pos = struct.calcsize("=" + "".join(f for _, f in snapshot_header))
+    ranges = []
+    for count, size in snapshot_arrays:
+        ranges.append((pos, pos + header[count] * size))
+        pos += (header[count] * size + 7) // 8 * 8
+    return ranges[-2], ranges[-1]
+
+
+if __name__ == '__main__':
+    unittest.main()